@@ -0,0 +1,82 @@
+/**
+ *  @file
+ *  @Author Septillion (https://github.com/septillion-git)
+ *  @date 2026-10-16
+ *  @brief Example how to use FadeLed library with an easing curve.
+ *
+ *  @details This is an example how to shape a fade with an easing curve. The
+ *  LEDs on pins 9, 10 and 11 fade up and down like a sine wave, one after the
+ *  other. The easing curve (FadeLedEaseInOutSine) only changes how the fade
+ *  moves over time, the gamma table stays the same. So the brightness you see
+ *  follows the sine.
+ *
+ *  FadeLedEasing.h has more curves. Your own curve can be made with
+ *  'extras/EasingTable.py'. The 'SineFade' example gets a sine from a custom
+ *  gamma table instead.
+ *
+ *  @note Set FADE_LED_EASING to 1 in FadeLed.h (or as build flag) to use this
+ *  example. Setting it in the sketch doesn't change the library.
+ */
+
+#include <FadeLed.h>
+
+#if !FADE_LED_EASING
+  #error Set FADE_LED_EASING to 1 in FadeLed.h for this example
+#endif
+
+//Make FadeLed objects with the default gamma table
+FadeLed sines[3] = {9, 10, 11};
+const byte NrSines = sizeof(sines)/sizeof(sines[0]); //Number of sines
+
+void setup(){
+  //loop all sines to set them to the same (constant speed) fading time and a sine shape
+  for(byte i = 0; i < NrSines; i++){
+    sines[i].setTime(5000); //halve period, off to on or on to off
+    sines[i].setEasing(FadeLedEaseInOutSine);
+  }
+
+  //Turn on the first to get started
+  sines[0].on();
+}
+
+void loop(){
+  FadeLed::update();
+
+  //If all sines are off, start over by turning the first sine on.
+  if(allOff()){
+    delay(1000);
+    sines[0].on();
+  }
+
+  for(byte i = 0; i < NrSines; i++){
+    //if sin is 100%, fade back down
+    if(sines[i].done() && sines[i].get()){
+      sines[i].off();
+    }
+
+    //for all but first
+    if(i > 0){
+      //if previous sine is past halfway and this sine is off and not fading, start fading
+      if( (sines[i - 1].getCurrent() >= sines[i - 1].getBiggestStep() / 2)
+          && sines[i].done()
+          && (sines[i].get() == 0) )
+      {
+        sines[i].on();
+      }
+    }
+  }
+}
+
+//returns true is all sines are turned off (at step 0)
+bool allOff(){
+  bool rtn = true;
+
+  //check all sines, if a sine is not currently off (step 0)
+  // or set to off (step 0), it set rtn to false.
+  for(byte i = 0; i < NrSines; i++){
+    rtn &= !sines[i].getCurrent();
+    rtn &= !sines[i].get();
+  }
+
+  return rtn;
+}
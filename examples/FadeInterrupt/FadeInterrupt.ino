@@ -0,0 +1,67 @@
+/**
+ *  @file
+ *  @Author Septillion (https://github.com/septillion-git)
+ *  @date 2026-10-16
+ *  @brief Example how to let a timer interrupt do the fading
+ *  
+ *  @details This is an example how to use FadeLed library with FADE_LED_ISR.
+ *  The fading is done by a timer interrupt so it keeps going while loop() is
+ *  blocked by delay(). Here the LED on pin 9 fades up and down every 2 seconds 
+ *  while loop() blinks the LED on pin 13 with delay().
+ *  
+ *  For an Uno/Nano/Pro Mini (ATmega328P). It uses the compare match A 
+ *  interrupt of timer 0, the timer that also runs millis(). It fires every 
+ *  1.024ms, so the interval is a bit longer than set.
+ *  
+ *  @note Set FADE_LED_ISR to 1 in FadeLed.h (or as build flag) to use this 
+ *  example. Setting it in the sketch doesn't change the library.
+ */
+
+#include <FadeLed.h>
+
+#if !FADE_LED_ISR
+  #error Set FADE_LED_ISR to 1 in FadeLed.h for this example
+#endif
+
+FadeLed led(9);
+
+const byte BlinkPin = 13;
+
+void setup() {
+  pinMode(BlinkPin, OUTPUT);
+  
+  //Set up everything before the interrupt starts
+  FadeLed::setInterval(10);
+  led.setTime(2000);
+  
+  //Also interrupt halfway each timer 0 cycle
+  OCR0A = 0x80;
+  TIMSK0 |= _BV(OCIE0A);
+}
+
+//Called every 1.024ms, do a tick every interval
+ISR(TIMER0_COMPA_vect){
+  static byte count = 0;
+  
+  if(++count >= FadeLed::getInterval()){
+    count = 0;
+    FadeLed::tick();
+  }
+}
+
+void loop() {
+  //No need to call FadeLed::update() (only for output backends)
+  
+  if(led.done()){
+    if(led.get()){
+      led.off();
+    }
+    else{
+      led.on();
+    }
+  }
+  
+  //Blocking, but the fade just continues
+  digitalWrite(BlinkPin, !digitalRead(BlinkPin));
+  delay(500);
+}
@@ -18,10 +18,8 @@
 
 #include <FadeLed.h>
 
-//the RGB LED
-FadeLed redLed(9);
-FadeLed greenLed(10);
-FadeLed blueLed(11);
+//the RGB LED, red, green and blue fade together
+FadeLedGroup<3> rgbLed({9, 10, 11});
 
 //used to time
 unsigned long millisLast = -1;
@@ -31,11 +29,8 @@ void setup() {
   //Set update interval to 10ms
   FadeLed::setInterval(10);
   
-  //set all colors to same time and to constant fade time
   //Each color change will take 5 seconds
-  redLed.setTime(5000, true);
-  greenLed.setTime(5000, true);
-  blueLed.setTime(5000, true);
+  rgbLed.setTime(5000);
   
   //Give the random a random seed from the noise from the ADC of A0
   randomSeed(analogRead(A0));
@@ -50,9 +45,13 @@ void loop() {
     //Save time for the next time
     millisLast += Interval;
     
-    //set each color to a new random value to create a new random color
-    redLed.set(random(0, 256));
-    greenLed.set(random(0, 256));
-    blueLed.set(random(0, 256));
+    //pick a new random value for each color to create a new random color
+    flvar_t color[3];
+    for(byte i = 0; i < 3; i++){
+      color[i] = random(0, rgbLed.getBiggestStep() + 1);
+    }
+    
+    //all colors start and end the fade together
+    rgbLed.set(color);
   }
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+/**
+ *  @file
+ *  @brief Example how to play sequences of fades with FadeLedSequence
+ *
+ *  @details This is an example how to let FadeLed play patterns on its own.
+ *  Each pattern is a list of keyframes in PROGMEM. A FadeLedSequence plays
+ *  it on a LED from within FadeLed::update(), loop() has nothing else to do.
+ *
+ *  pin 9
+ *  Breathes: slow fade up, a bit faster down, short pause, forever.
+ *
+ *  pin 10
+ *  Beats like a heart: two quick pulses, a pause, forever.
+ *
+ *  pin 11
+ *  Blinks softly three times, waits two seconds and does it again. After
+ *  that it fades to halve brightness and stays there.
+ */
+
+#include <FadeLed.h>
+
+const FadeLedKeyframe Breathe[] PROGMEM = {
+  FadeLedFade(100, 2000),
+  FadeLedFade(5, 1500),
+  FadeLedHold(400),
+  FadeLedGoTo(0)
+};
+
+const FadeLedKeyframe Heartbeat[] PROGMEM = {
+  FadeLedFade(100, 100),
+  FadeLedFade(20, 150),
+  FadeLedFade(80, 100),
+  FadeLedFade(0, 300),
+  FadeLedHold(700),
+  FadeLedGoTo(0)
+};
+
+const FadeLedKeyframe Blinks[] PROGMEM = {
+  FadeLedFade(100, 200),   //0
+  FadeLedFade(0, 200),     //1
+  FadeLedHold(300),        //2
+  FadeLedRepeat(0, 2),     //3, back to 0 two more times
+  FadeLedHold(2000),       //4
+  FadeLedFade(100, 200),   //5
+  FadeLedFade(0, 200),     //6
+  FadeLedHold(300),        //7
+  FadeLedRepeat(5, 2),     //8
+  FadeLedFade(50, 1000),   //9
+  FadeLedEnd()
+};
+
+FadeLed leds[3] = {9, 10, 11};
+
+FadeLedSequence breathe(leds[0]);
+FadeLedSequence heartbeat(leds[1]);
+FadeLedSequence blinks(leds[2]);
+
+void setup(){
+  //short interval for the quick fades of the heartbeat
+  FadeLed::setInterval(10);
+
+  breathe.play(Breathe);
+  heartbeat.play(Heartbeat);
+  blinks.play(Blinks);
+}
+
+void loop(){
+  FadeLed::update();
+}
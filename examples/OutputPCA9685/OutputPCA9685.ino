@@ -0,0 +1,103 @@
+/**
+ *  @file
+ *  @Author Septillion (https://github.com/septillion-git)
+ *  @date 2026-10-16
+ *  @brief Example how to use FadeLed with a PCA9685 I2C PWM driver
+ *  
+ *  @details This is an example how to use FadeLed with an output backend. The 
+ *  16 channels of a PCA9685 (address 0x40) fade up one after another and 
+ *  back down again.
+ *  
+ *  The FadeLed objects don't write to the PCA9685 themselves. They write to 
+ *  the frame buffer of the backend. FadeLed::update() sends all changed 
+ *  channels once per update in one auto-increment write (split in chunks 
+ *  that fit the Wire buffer).
+ */
+
+#include <Wire.h>
+#include <FadeLed.h>
+
+class Pca9685 : public FadeLedOutput{
+  public:
+    Pca9685(byte address) : FadeLedOutput(_levels, 16), _address(address) {}
+    
+    void begin(){
+      Wire.begin();
+      writeRegister(0x00, 0x20); //MODE1: auto-increment on, oscillator on
+      writeRegister(0x01, 0x04); //MODE2: totem pole outputs
+      
+      //all channels off
+      for(byte i = 0; i < 16; i++){
+        _levels[i] = 0;
+      }
+      flush(0, 15);
+    }
+    
+  protected:
+    flvar_t _levels[16];
+    const byte _address;
+    
+    //registers LEDn_ON_L to LEDn_OFF_H of a channel are at 0x06 + 4 * n
+    static const byte FirstLedRegister = 0x06;
+    
+    //channels per transaction, the register address + 4 bytes per channel
+    //must fit the Wire buffer (32 bytes on AVR)
+    static const byte ChannelsPerWrite = 7;
+    
+    void flush(byte first, byte last){
+      while(first <= last){
+        Wire.beginTransmission(_address);
+        Wire.write(FirstLedRegister + 4 * first);
+        
+        for(byte i = 0; i < ChannelsPerWrite && first <= last; i++, first++){
+          //scale to the 12-bit of the PCA9685
+          unsigned int level = (unsigned long)read(first) * 4095 / FADE_LED_RESOLUTION;
+          
+          Wire.write(0x00); //ON_L
+          //full on needs bit 4 of ON_H, full off bit 4 of OFF_H
+          Wire.write(level >= 4095 ? 0x10 : 0x00); //ON_H
+          Wire.write(level & 0xFF); //OFF_L
+          Wire.write(level == 0 ? 0x10 : (level >> 8) & 0x0F); //OFF_H
+        }
+        Wire.endTransmission();
+      }
+    }
+    
+    void writeRegister(byte reg, byte val){
+      Wire.beginTransmission(_address);
+      Wire.write(reg);
+      Wire.write(val);
+      Wire.endTransmission();
+    }
+};
+
+Pca9685 pwmDriver(0x40);
+
+//a FadeLed object per channel, the pin is the channel of the PCA9685
+FadeLed leds[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+const byte NrLeds = sizeof(leds) / sizeof(leds[0]);
+
+void setup(){
+  pwmDriver.begin();
+  
+  for(byte i = 0; i < NrLeds; i++){
+    leds[i].setOutput(&pwmDriver);
+    leds[i].setTime(1000);
+  }
+  
+  leds[0].on();
+}
+
+void loop(){
+  FadeLed::update();
+  
+  for(byte i = 0; i < NrLeds; i++){
+    if(leds[i].done()){
+      //at full brightness, start the next and fade this one off
+      if(leds[i].get()){
+        leds[(i + 1) % NrLeds].on();
+        leds[i].off();
+      }
+    }
+  }
+}
@@ -0,0 +1,55 @@
+/**
+ *  @file
+ *  @brief Example how to crossfade all LEDs to a scene with FadeLedScene
+ *
+ *  @details This is an example how to switch a few LEDs between lighting
+ *  scenes. Each scene is a brightness for every LED of a list. One call fades
+ *  all of them to it, starting at the same time and finishing at the same
+ *  time.
+ *
+ *  pin 3, 5, 6 and 9
+ *  Start off, fade to Day in 3 seconds, to Evening in 5 seconds and to Night
+ *  in 8 seconds. After that a short Show, and then back to how it was before
+ *  the show.
+ */
+
+#include <FadeLed.h>
+
+FadeLed leds[4] = {3, 5, 6, 9};
+//the LEDs of the scenes, in the order of the brightnesses
+FadeLed* const Leds[] = {&leds[0], &leds[1], &leds[2], &leds[3]};
+
+const flvar_t Day[] PROGMEM = {100, 100, 80, 80};
+const flvar_t Evening[] PROGMEM = {60, 30, 10, 0};
+const flvar_t Night[] PROGMEM = {5, 0, 0, 0};
+const flvar_t Show[] PROGMEM = {0, 100, 0, 100};
+
+FadeLedScene day(Leds, Day, 4);
+FadeLedScene evening(Leds, Evening, 4);
+FadeLedScene night(Leds, Night, 4);
+FadeLedScene show(Leds, Show, 4);
+
+//scene in RAM to go back to
+FadeLedSnapshot<4> before(Leds);
+
+FadeLedScene* const Program[] = {&day, &evening, &night, &show, &before};
+const unsigned long Times[] = {3000, 5000, 8000, 500, 2000};
+byte step = 0;
+
+void setup(){
+  Program[0]->fade(Times[0]);
+}
+
+void loop(){
+  FadeLed::update();
+
+  //next scene when all LEDs got there, with a little pause
+  if(step < 4 && Program[step]->done()){
+    delay(1000);
+    step++;
+    if(Program[step] == &show){
+      before.capture();
+    }
+    Program[step]->fade(Times[step]);
+  }
+}
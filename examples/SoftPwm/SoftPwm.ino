@@ -0,0 +1,71 @@
+/**
+ *  @file
+ *  @Author Septillion (https://github.com/septillion-git)
+ *  @date 2026-10-16
+ *  @brief Example how to fade LEDs on pins without hardware PWM
+ *
+ *  @details This is an example how to use FadeLed with FadeLedBam, software
+ *  PWM (bit angle modulation) on ordinary pins. The 8 LEDs on pins 2, 4, 7,
+ *  8, 12, 13, A0 and A1 (none of them a PWM pin on an Uno) light up one after
+ *  another like a wave.
+ *
+ *  Timer1 (so AVR only) runs in CTC mode at 2MHz and calls FadeLedBam::isr().
+ *  One unit is 24 counts (12us), a cycle of 8 bits takes 255 units so the
+ *  LEDs are driven at 327Hz. The hardware PWM of pin 9 and 10 (also Timer1)
+ *  can't be used with it.
+ */
+
+#include <FadeLed.h>
+
+const byte Pins[] = {2, 4, 7, 8, 12, 13, A0, A1};
+const byte NrLeds = sizeof(Pins);
+const unsigned int Unit = 24; //timer counts in the shortest slot
+
+FadeLedBam<NrLeds> bam(Pins);
+
+//the channels of bam
+FadeLed leds[NrLeds] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+byte next = 1; //LED to start next
+
+ISR(TIMER1_COMPA_vect){
+  //the next interrupt after the slot of the bit just written
+  OCR1A = bam.isr() * Unit - 1;
+}
+
+void setup(){
+  bam.begin();
+  for(byte i = 0; i < NrLeds; i++){
+    leds[i].setOutput(&bam);
+    leds[i].setTime(600, true);
+  }
+
+  //Timer1 CTC mode on OCR1A, prescaler 8
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM12) | _BV(CS11);
+  TCNT1 = 0;
+  OCR1A = Unit - 1;
+  TIMSK1 = _BV(OCIE1A);
+  interrupts();
+
+  leds[0].on();
+}
+
+void loop(){
+  FadeLed::update();
+
+  //start the next LED when the one before is halfway
+  byte last = (next + NrLeds - 1) % NrLeds;
+  if(leds[last].getCurrent() >= leds[last].getBiggestStep() / 2 && leds[next].done() && !leds[next].get()){
+    leds[next].on();
+    next = (next + 1) % NrLeds;
+  }
+
+  //fade back once fully on
+  for(byte i = 0; i < NrLeds; i++){
+    if(leds[i].done() && leds[i].get()){
+      leds[i].off();
+    }
+  }
+}
@@ -0,0 +1,91 @@
+## Creates easing tables for FadeLed::setEasing()
+#  An easing table has 33 values: the eased progress at 0/32, 1/32 ... 32/32 of
+#  a fade, in 1/32768. The first value is always 0 and the last 32768. FadeLed
+#  interpolates between them.
+#
+#  python EasingTable.py
+#    writes the shipped curves to easing.h (the tables of src/FadeLedEasing.h)
+#  python EasingTable.py "<expression of t>" [name]
+#    writes a table for your own curve to easing.h, t goes from 0 to 1. Like
+#    python EasingTable.py "t ** 1.5" myEasing
+#
+#  The curve should rise from 0 (t = 0) to 1 (t = 1) and never go down.
+#
+import math
+import sys
+
+Segments = 32
+One = 32768
+
+def easeInOut(easeIn):
+  return lambda t: easeIn(2 * t) / 2 if t < 0.5 else 1 - easeIn(2 - 2 * t) / 2
+
+def easeOut(easeIn):
+  return lambda t: 1 - easeIn(1 - t)
+
+def inQuad(t):
+  return t * t
+
+def inCubic(t):
+  return t * t * t
+
+def inSine(t):
+  return 1 - math.cos(t * math.pi / 2)
+
+def inExpo(t):
+  return 0.0 if t == 0 else math.pow(2, 10 * t - 10)
+
+Curves = [
+  ("FadeLedEaseInQuad", "quadratic ease in (t^2)", inQuad),
+  ("FadeLedEaseOutQuad", "quadratic ease out", easeOut(inQuad)),
+  ("FadeLedEaseInOutQuad", "quadratic ease in and out", easeInOut(inQuad)),
+  ("FadeLedEaseInCubic", "cubic ease in (t^3)", inCubic),
+  ("FadeLedEaseOutCubic", "cubic ease out", easeOut(inCubic)),
+  ("FadeLedEaseInOutCubic", "cubic ease in and out", easeInOut(inCubic)),
+  ("FadeLedEaseInSine", "sine ease in (quarter of a cosine)", inSine),
+  ("FadeLedEaseOutSine", "sine ease out (quarter of a sine)", easeOut(inSine)),
+  ("FadeLedEaseInOutSine", "sine ease in and out (half a cosine)", easeInOut(inSine)),
+  ("FadeLedEaseInExpo", "exponential ease in (2^(10t - 10))", inExpo),
+  ("FadeLedEaseOutExpo", "exponential ease out", easeOut(inExpo)),
+  ("FadeLedEaseInOutExpo", "exponential ease in and out", easeInOut(inExpo)),
+]
+
+def values(curve):
+  out = [min(One, max(0, int(round(curve(i / Segments) * One)))) for i in range(Segments + 1)]
+  #exact ends, so a fade starts and ends at the set brightness
+  out[0] = 0
+  out[-1] = One
+  return out
+
+def table(name, comment, curve):
+  text = "/* Easing: %s */\n" % comment
+  text += "const uint16_t %s[FadeLedEasingSize] PROGMEM = {\n\t" % name
+  vals = values(curve)
+  for index, value in enumerate(vals, 1):
+    text += "%5i" % value
+    if(index != len(vals)):
+      if(index % 11 == 0):
+        text += ",\n\t"
+      else:
+        text += ", "
+  text += "\n};\n"
+  return text
+
+if __name__ == "__main__":
+  output = open("easing.h", "w")
+
+  if(len(sys.argv) >= 2):
+    expression = sys.argv[1]
+    varName = sys.argv[2] if len(sys.argv) >= 3 else "myEasing"
+    curve = lambda t: eval(expression, {"math": math, "t": t})
+    vals = values(curve)
+    if(any(b < a for a, b in zip(vals, vals[1:]))):
+      print("Warning: the curve goes down somewhere, FadeLed needs a rising curve")
+    output.write(table(varName, expression, curve))
+
+  else:
+    for name, comment, curve in Curves:
+      output.write(table(name, comment, curve))
+      output.write("\n")
+
+  output.close()
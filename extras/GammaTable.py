@@ -2,6 +2,9 @@
 #  Step 0 is always 0 (off)
 #  Step 1 is always non-0 to get the biggest range possible
 #  
+#  FadeLedGammaCurve (src/FadeLedGammaCurve.h) makes the same table at compile
+#  time. Keep the two the same, the host benchmark checks it.
+#  
 import math
 import sys
 
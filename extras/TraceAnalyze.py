@@ -0,0 +1,183 @@
+## Analyzes a trace of FadeLedTrace (FADE_LED_TRACE)
+#  Reports the jitter of the ticks, the step sizes and the steps against the
+#  fade direction per pin and how long each fade took compared to setTime().
+#
+#  python TraceAnalyze.py trace.bin
+#    analyzes a trace saved to a file, from FadeLedTrace::dump() on the board
+#    or from the host build (fadeled_trace_8 --trace trace.bin)
+#  python TraceAnalyze.py --serial <port> [baud] [trace.bin]
+#    waits for FadeLedTrace::dump(Serial) on the port (needs pyserial), saves
+#    it to trace.bin if given and analyzes it
+#
+#  The trace is little endian (AVR, ARM and ESP). A fade is done at the first
+#  write of the level it ends at. With a gamma table that gives several steps
+#  the same output level a fade can look done a bit early, with dithering the
+#  output goes up and down between two levels on purpose.
+#
+import struct
+import sys
+
+HeaderFormat = "<4sBBHHHI"
+RecordFormat = "<IHBB"
+Write, Tick, Fade, Duration = range(4)
+
+def parse(data):
+  headerSize = struct.calcsize(HeaderFormat)
+  recordSize = struct.calcsize(RecordFormat)
+  start = data.find(b"FLTR")
+  if(start < 0 or len(data) < start + headerSize):
+    raise ValueError("no FadeLedTrace dump found")
+  magic, version, bits, interval, count, size, total = struct.unpack_from(HeaderFormat, data, start)
+  if(version != 1):
+    raise ValueError("unknown trace version %i" % version)
+  header = {"bits": bits, "interval": interval, "count": count, "size": size, "total": total}
+  records = []
+  offset = start + headerSize
+  for i in range(count):
+    if(offset + recordSize > len(data)):
+      print("Warning: trace cut off after %i of %i records" % (i, count))
+      break
+    records.append(struct.unpack_from(RecordFormat, data, offset))
+    offset += recordSize
+  return header, records
+
+def readSerial(port, baud):
+  import serial
+  link = serial.Serial(port, baud, timeout = 10)
+  data = b""
+  #wait for the header, then read the records it announces
+  while(b"FLTR" not in data):
+    chunk = link.read(64)
+    if(not chunk):
+      raise ValueError("no dump received on %s" % port)
+    data = (data + chunk)[-(4 + 64):]
+  data = data[data.find(b"FLTR"):]
+  headerSize = struct.calcsize(HeaderFormat)
+  data += link.read(max(0, headerSize - len(data)))
+  count = struct.unpack_from(HeaderFormat, data)[4]
+  data += link.read(max(0, headerSize + count * struct.calcsize(RecordFormat) - len(data)))
+  return data
+
+def since(start, end):
+  #micros() rolls over
+  return (end - start) & 0xFFFFFFFF
+
+def stats(values):
+  mean = sum(values) / len(values)
+  deviation = (sum((v - mean) ** 2 for v in values) / len(values)) ** 0.5
+  return mean, min(values), max(values), deviation
+
+def analyzeTicks(header, records):
+  ticks = [rec[0] for rec in records if rec[3] == Tick]
+  print("Ticks: %i" % len(ticks))
+  if(len(ticks) < 2):
+    return
+  interval = header["interval"] * 1000
+  deltas = [since(a, b) for a, b in zip(ticks, ticks[1:])]
+  jitter = [d - interval for d in deltas]
+  mean, low, high, deviation = stats(jitter)
+  late = sum(1 for d in deltas if d >= interval * 3 // 2)
+  print("  interval %ius, jitter mean %.0fus, min %ius, max %ius, std dev %.0fus" %
+        (interval, mean, low, high, deviation))
+  print("  %i of %i ticks came half an interval or more late" % (late, len(deltas)))
+
+def analyzeSteps(records):
+  pins = sorted(set(rec[2] for rec in records if rec[3] == Write))
+  print("Steps per pin (between writes):")
+  print("  %4s %7s %7s %9s %9s %9s" % ("pin", "writes", "same", "max step", "avg step", "backward"))
+  for pin in pins:
+    last = None
+    direction = 0
+    target = None
+    steps = []
+    same = 0
+    backward = 0
+    writes = 0
+    for time, value, recPin, kind in records:
+      if(recPin != pin):
+        continue
+      if(kind == Fade):
+        target = value
+        direction = 0 if last is None else (value > last) - (value < last)
+      elif(kind == Write):
+        writes += 1
+        if(last is not None):
+          step = value - last
+          if(step == 0):
+            same += 1
+          else:
+            steps.append(abs(step))
+          #against the direction of the fade it's in
+          if(direction and target is not None and step * direction < 0):
+            backward += 1
+        if(value == target):
+          direction = 0
+        last = value
+    average = sum(steps) / len(steps) if steps else 0
+    print("  %4i %7i %7i %9i %9.1f %9i" % (pin, writes, same, max(steps) if steps else 0, average, backward))
+
+def analyzeFades(header, records):
+  interval = header["interval"]
+  fades = []
+  for index, (time, value, pin, kind) in enumerate(records):
+    if(kind != Fade or index + 1 >= len(records) or records[index + 1][3] != Duration):
+      continue
+    expected = records[index + 1][0]
+    fades.append((index, pin, value, expected))
+
+  print("Fades: %i" % len(fades))
+  if(not fades):
+    return
+  print("  %4s %7s %12s %12s %10s" % ("pin", "level", "expected ms", "took ms", "error ms"))
+  errors = []
+  for index, pin, target, expected in fades:
+    firstTick = None
+    took = None
+    state = "not done"
+    for time, value, recPin, kind in records[index + 2:]:
+      if(kind == Tick and firstTick is None):
+        firstTick = time
+      elif(recPin == pin and kind == Fade):
+        state = "changed"
+        break
+      elif(recPin == pin and kind == Write and value == target and firstTick is not None):
+        #the first tick ends the first interval of the fade
+        took = since(firstTick, time) / 1000 + interval
+        break
+    if(took is None):
+      print("  %4i %7i %12s %12s %10s" % (pin, target, expected or "?", state, ""))
+    elif(not expected):
+      print("  %4i %7i %12s %12.0f %10s" % (pin, target, "?", took, ""))
+    else:
+      errors.append(took - expected)
+      print("  %4i %7i %12i %12.0f %10.0f" % (pin, target, expected, took, took - expected))
+  if(errors):
+    print("  duration error mean %.0fms, max %.0fms" % (sum(errors) / len(errors), max(errors, key = abs)))
+
+def analyze(data):
+  header, records = parse(data)
+  print("FadeLed trace: %i-bit PWM, interval %ims, %i records" % (header["bits"], header["interval"], len(records)))
+  if(header["total"] > header["count"]):
+    print("  the oldest %i records were overwritten, a bigger FADE_LED_TRACE_SIZE keeps more" % (header["total"] - header["count"]))
+  if(not records):
+    return
+  print("  %.1fms traced" % (since(records[0][0], records[-1][0]) / 1000))
+  analyzeTicks(header, records)
+  analyzeSteps(records)
+  analyzeFades(header, records)
+
+if __name__ == "__main__":
+  if(len(sys.argv) >= 3 and sys.argv[1] == "--serial"):
+    baud = int(sys.argv[3]) if len(sys.argv) >= 4 else 115200
+    data = readSerial(sys.argv[2], baud)
+    if(len(sys.argv) >= 5):
+      with open(sys.argv[4], "wb") as output:
+        output.write(data)
+  elif(len(sys.argv) == 2):
+    with open(sys.argv[1], "rb") as trace:
+      data = trace.read()
+  else:
+    print("usage: python TraceAnalyze.py trace.bin")
+    print("       python TraceAnalyze.py --serial <port> [baud] [trace.bin]")
+    sys.exit(1)
+  analyze(data)
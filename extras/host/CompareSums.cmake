@@ -0,0 +1,45 @@
+# Runs a benchmark with --quick and keeps the checksum column of the fades.
+#
+#   cmake -DBENCH=<benchmark> -DSUMS=<file> [-DSAME_AS=<file>] -P CompareSums.cmake
+#
+# Writes the checksums to SUMS. With SAME_AS every checksum in that file must
+# be given by the benchmark as well, it may have more rows (like the ease rows
+# of FADE_LED_EASING). Fails if the benchmark fails, for example when it
+# printed DIFFERS or WRONG, or if a checksum is not the same.
+
+execute_process(COMMAND ${BENCH} --quick
+  OUTPUT_VARIABLE output
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${BENCH} failed (${result}):\n${output}")
+endif()
+
+# the speed, time, ease and pattern rows, not the ones of the core table
+string(REPLACE "\n" ";" lines "${output}")
+set(sums)
+foreach(line ${lines})
+  # the last match sets CMAKE_MATCH_<n>
+  if(NOT line MATCHES "gamma|linear" AND line MATCHES "^(speed|time|ease|pattern) +([0-9]+) .* ([0-9a-f]+)$")
+    list(APPEND sums "${CMAKE_MATCH_1} ${CMAKE_MATCH_2} ${CMAKE_MATCH_3}")
+  endif()
+endforeach()
+if(NOT sums)
+  message(FATAL_ERROR "${BENCH} printed no checksums:\n${output}")
+endif()
+string(REPLACE ";" "\n" text "${sums}")
+file(WRITE ${SUMS} "${text}\n")
+
+if(SAME_AS)
+  file(STRINGS ${SAME_AS} expected)
+  set(missing)
+  foreach(row ${expected})
+    list(FIND sums "${row}" found)
+    if(found EQUAL -1)
+      list(APPEND missing "${row}")
+    endif()
+  endforeach()
+  if(missing)
+    string(REPLACE ";" "\n" missing "${missing}")
+    message(FATAL_ERROR "${BENCH} gives other checksums than ${SAME_AS}.\nExpected:\n${missing}\nGot:\n${text}\n")
+  endif()
+endif()
@@ -0,0 +1,1464 @@
+/**
+ *  @file FadeLedBench.cpp
+ *  @brief Host benchmark of FadeLed::update()
+ *
+ *  @details Runs fades on 1 up to 10000 objects on the simulated Arduino core,
+ *  one executable per FADE_LED_PWM_BITS width and configuration (see
+ *  extras/host/CMakeLists.txt). First it checks FadeLedGammaCurve gives the
+ *  same tables as extras/GammaTable.py. Then it prints a table per part of
+ *  the library:
+ *
+ *  - speed, time, ease, dither: full fades with constant speed, constant time,
+ *    an easing curve (FADE_LED_EASING) and dithering (FADE_LED_DITHER). Gives
+ *    the time per LED per tick, the analogWrite() calls per tick and a checksum.
+ *  - slow: fades of a minute and more, what FADE_LED_SCHEDULER saves.
+ *  - sequence: a looping FadeLedSequence pattern on every LED.
+ *  - output: the speed fades on mock FadeLedOutput backends, bus transactions.
+ *  - rgb: FadeLed objects per channel against one FadeLedGroup<3> per light.
+ *  - gamma (12-bit and up): flash use, error and lookup time of compressed
+ *    gamma tables.
+ *  - idle and react: a tick with nothing or one LED fading, and finding the
+ *    finished fades with done() or FadeLed::completed().
+ *  - retarget (FADE_LED_RETARGET): each FadeLed::Retarget mode turning back a fade.
+ *  - stats (FADE_LED_STATS): the counters of FadeLed::stats().
+ *  - bam: FadeLedBam::isr() and building the bit planes, checks the duty.
+ *  - core: FadeLed against FadeLedCore with the same table.
+ *  - scene: starting a crossfade with set() on each LED or a FadeLedScene.
+ *  - master (FADE_LED_MASTER): no, full and fading master dimmers, checks
+ *    each pin after every tick.
+ *  - layers: FadeLedLayers with 1 up to 8 layers, checks the blend.
+ *  - late: a fade with update() called every few intervals, over the roll
+ *    over of millis() (on time with FADE_LED_ELAPSED_TIME).
+ *
+ *  The checksum column is a hash over every analogWrite(). A change to the fade
+ *  engine that should not change the output must keep it the same, ctest
+ *  compares it between the configurations. Tables that compare two ways print
+ *  DIFFERS or WRONG when they don't match and the benchmark then returns 1.
+ *
+ *  With FADE_LED_TRACE, --trace writes a trace of a few fades (with some late
+ *  updates) for extras/TraceAnalyze.py to a file instead.
+ *
+ *  Usage: fadeled_bench [--quick] [--trace file]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "FadeLed.h"
+#include "FadeLedHal.h"
+#include "FadeLedMockOutput.h"
+
+namespace{
+  const unsigned int Interval = 50;
+  const unsigned long FadeTime = 2000;
+  const unsigned long TicksPerFade = FadeTime / Interval;
+  const unsigned int LedCounts[] = {1, 10, 100, 1000, 10000};
+
+  unsigned long minLedTicks = 4000000UL;
+
+  struct Result{
+    double nsPerLedTick;
+    double writesPerTick;
+    uint32_t hash;
+  };
+
+  typedef std::chrono::steady_clock Clock;
+
+  //Makes the next call to update() a tick
+  void tick(){
+    FadeLedHal::advance(Interval);
+    FadeLed::update();
+  }
+
+  //Runs a number of ticks, returns the ns they took
+  double runFade(unsigned long ticks){
+    Clock::time_point start = Clock::now();
+    for(unsigned long i = 0; i < ticks; i++){
+      tick();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  }
+
+  bool allDone(std::vector<FadeLed*>& leds){
+    for(size_t i = 0; i < leds.size(); i++){
+      if(!leds[i]->done()){
+        return false;
+      }
+    }
+    return true;
+  }
+
+  enum Mode{
+    Speed,
+    Time,
+    Dither,
+    Ease,
+    NrModes
+  };
+  
+  const char* const ModeNames[NrModes] = {"speed", "time", "dither", "ease"};
+  
+  Result benchFades(unsigned int count, Mode mode){
+    bool constTime = (mode == Time || mode == Ease);
+    std::vector<FadeLed*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(new FadeLed(i & 0xFF));
+      leds.back()->setTime(FadeTime, constTime);
+      #if FADE_LED_DITHER
+      leds.back()->setDither(mode == Dither);
+      #endif
+      #if FADE_LED_EASING
+      if(mode == Ease){
+        leds.back()->setEasing(FadeLedEaseInOutCubic);
+      }
+      #endif
+    }
+
+    //sync update() to the simulated clock, the same start time whatever ran before, the checksum includes the time
+    FadeLedHal::setMillis(1000000UL);
+    tick();
+    tick();
+
+    unsigned long rounds = minLedTicks / (2 * TicksPerFade * count);
+    if(rounds == 0){
+      rounds = 1;
+    }
+
+    FadeLedHal::resetWrites();
+    double ns = 0;
+    for(unsigned long r = 0; r < rounds; r++){
+      for(unsigned int i = 0; i < count; i++){
+        if(constTime){
+          leds[i]->set(1 + (i * 37UL) % leds[i]->getBiggestStep());
+        }
+        else{
+          leds[i]->on();
+        }
+      }
+      ns += runFade(TicksPerFade);
+
+      for(unsigned int i = 0; i < count; i++){
+        leds[i]->off();
+      }
+      ns += runFade(TicksPerFade);
+    }
+
+    if(!allDone(leds)){
+      printf("  warning: not all fades done after %lu ticks\n", TicksPerFade);
+    }
+
+    Result res;
+    unsigned long ticks = rounds * 2 * TicksPerFade;
+    res.nsPerLedTick = ns / ticks / count;
+    res.writesPerTick = (double)FadeLedHal::writes() / ticks;
+    res.hash = FadeLedHal::writeHash();
+
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return res;
+  }
+  
+  struct OutputResult{
+    double nsPerLedTick;
+    double transactionsPerTick;
+    double channelsPerTick;
+  };
+  
+  //Same fades as Speed but written to mock output backends of 256 channels each
+  OutputResult benchOutput(unsigned int count){
+    std::vector<FadeLedMockOutput*> outputs;
+    std::vector<FadeLed*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      if(i % 256 == 0){
+        outputs.push_back(new FadeLedMockOutput());
+      }
+      leds.push_back(new FadeLed(i & 0xFF));
+      leds.back()->setOutput(outputs.back());
+      leds.back()->setTime(FadeTime);
+    }
+    tick();
+    tick();
+    
+    unsigned long rounds = minLedTicks / (2 * TicksPerFade * count);
+    if(rounds == 0){
+      rounds = 1;
+    }
+    
+    double ns = 0;
+    for(unsigned long r = 0; r < rounds; r++){
+      for(unsigned int i = 0; i < count; i++){
+        leds[i]->on();
+      }
+      ns += runFade(TicksPerFade);
+      
+      for(unsigned int i = 0; i < count; i++){
+        leds[i]->off();
+      }
+      ns += runFade(TicksPerFade);
+    }
+    
+    OutputResult res;
+    unsigned long ticks = rounds * 2 * TicksPerFade;
+    unsigned long transactions = 0;
+    unsigned long channels = 0;
+    for(size_t i = 0; i < outputs.size(); i++){
+      transactions += outputs[i]->transactions;
+      channels += outputs[i]->channelsSent;
+    }
+    res.nsPerLedTick = ns / ticks / count;
+    res.transactionsPerTick = (double)transactions / ticks;
+    res.channelsPerTick = (double)channels / ticks;
+    
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    for(size_t i = 0; i < outputs.size(); i++){
+      delete outputs[i];
+    }
+    return res;
+  }
+  
+  //Slow constant speed fades (60s and up, 101 steps) that change the output once every dozen ticks
+  Result benchSlow(unsigned int count){
+    const unsigned long SlowTime = 60000;
+    const unsigned long Spread = 16;
+    std::vector<FadeLed*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(new FadeLed(i & 0xFF));
+      //not all on the same tick
+      leds.back()->setTime(SlowTime + (i % Spread) * 5 * Interval);
+    }
+    //same start time whatever ran before, the checksum includes the time
+    FadeLedHal::setMillis(1000000UL);
+    tick();
+    tick();
+    
+    FadeLedHal::resetWrites();
+    for(unsigned int i = 0; i < count; i++){
+      leds[i]->on();
+    }
+    unsigned long ticks = (SlowTime + Spread * 5 * Interval) / Interval;
+    double ns = runFade(ticks);
+    
+    if(!allDone(leds)){
+      printf("  warning: not all fades done after %lu ticks\n", ticks);
+    }
+    
+    Result res;
+    res.nsPerLedTick = ns / ticks / count;
+    res.writesPerTick = (double)FadeLedHal::writes() / ticks;
+    res.hash = FadeLedHal::writeHash();
+    
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return res;
+  }
+  
+  const FadeLedKeyframe Pattern[] PROGMEM = {
+    FadeLedFade(100, 500),
+    FadeLedFade(20, 250),
+    FadeLedFade(80, 250),
+    FadeLedFade(0, 1000),
+    FadeLedHold(500),
+    FadeLedRepeat(0, 2),
+    FadeLedFadeSpeed(60, 2000),
+    FadeLedHold(1000),
+    FadeLedGoTo(0)
+  };
+  
+  //Every LED plays Pattern with a FadeLedSequence, the cost includes the fading
+  Result benchSequence(unsigned int count){
+    std::vector<FadeLed*> leds;
+    std::vector<FadeLedSequence*> sequences;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(new FadeLed(i & 0xFF));
+      sequences.push_back(new FadeLedSequence(*leds.back()));
+    }
+    //same start time whatever ran before, the checksum includes the time
+    FadeLedHal::setMillis(1000000UL);
+    tick();
+    tick();
+    
+    FadeLedHal::resetWrites();
+    for(unsigned int i = 0; i < count; i++){
+      sequences[i]->play(Pattern);
+    }
+    unsigned long ticks = minLedTicks / count;
+    if(ticks < 4 * TicksPerFade){
+      ticks = 4 * TicksPerFade;
+    }
+    double ns = runFade(ticks);
+    
+    Result res;
+    res.nsPerLedTick = ns / ticks / count;
+    res.writesPerTick = (double)FadeLedHal::writes() / ticks;
+    res.hash = FadeLedHal::writeHash();
+    
+    for(size_t i = 0; i < leds.size(); i++){
+      delete sequences[i];
+      delete leds[i];
+    }
+    return res;
+  }
+  
+  //A group fading up that gets a new time halfway must end at the set brightness. Like FadeLed::setTime() it goes on at
+  //the progress of the intervals passed in the new time, in steps of that time. A time that already passed ends it
+  bool checkGroupSetTime(unsigned long newTime){
+    FadeLedGroup<3> group({0, 1, 2});
+    group.noGammaTable();
+    group.setTime(FadeTime);
+    const flvar_t Vals[3] = {FADE_LED_RESOLUTION, FADE_LED_RESOLUTION / 2, 1};
+    group.set(Vals);
+    
+    const unsigned long Intervals = newTime / Interval;
+    const bool Running = Intervals > TicksPerFade / 2;
+    flvar_t last = 0;
+    bool ok = true;
+    for(unsigned long i = 0; i < 4 * TicksPerFade && !group.done(); i++){
+      if(i == TicksPerFade / 2){
+        group.setTime(newTime);
+      }
+      tick();
+      //after the jump to the new progress, steps of the new time (at most twice that, for rounding and easing)
+      if(i > TicksPerFade / 2 && Running){
+        ok &= (long)group.getCurrent(0) - (long)last <= (long)(2 * FADE_LED_RESOLUTION / Intervals);
+      }
+      last = group.getCurrent(0);
+    }
+    for(byte i = 0; i < 3; i++){
+      ok &= group.done() && group.getCurrent(i) == Vals[i];
+    }
+    return ok;
+  }
+  
+  //Constant time RGB fades on separate FadeLed objects or on FadeLedGroup<3>, in ns per channel per tick
+  double benchGroup(unsigned int lights, bool grouped){
+    const byte Channels = 3;
+    std::vector<FadeLed*> leds;
+    std::vector<FadeLedGroup<Channels>*> groups;
+    for(unsigned int i = 0; i < lights; i++){
+      const byte pins[Channels] = {(byte)(i * 3), (byte)(i * 3 + 1), (byte)(i * 3 + 2)};
+      if(grouped){
+        groups.push_back(new FadeLedGroup<Channels>(pins));
+        groups.back()->setTime(FadeTime);
+      }
+      else{
+        for(byte ch = 0; ch < Channels; ch++){
+          leds.push_back(new FadeLed(pins[ch]));
+          leds.back()->setTime(FadeTime, true);
+        }
+      }
+    }
+    tick();
+    tick();
+
+    unsigned long rounds = minLedTicks / (2 * TicksPerFade * lights * Channels);
+    if(rounds == 0){
+      rounds = 1;
+    }
+
+    double ns = 0;
+    for(unsigned long r = 0; r < rounds * 2; r++){
+      for(unsigned int i = 0; i < lights; i++){
+        flvar_t color[Channels];
+        for(byte ch = 0; ch < Channels; ch++){
+          color[ch] = (r & 1) ? 0 : (i * 37UL + ch * 59UL) % 101;
+        }
+        if(grouped){
+          groups[i]->set(color);
+        }
+        else{
+          for(byte ch = 0; ch < Channels; ch++){
+            leds[i * Channels + ch]->set(color[ch]);
+          }
+        }
+      }
+      ns += runFade(TicksPerFade);
+    }
+
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    for(size_t i = 0; i < groups.size(); i++){
+      delete groups[i];
+    }
+    return ns / (rounds * 2 * TicksPerFade) / (lights * Channels);
+  }
+  
+  //Compares a FadeLedGammaCurve with a table made by extras/GammaTable.py
+  template <class Curve, class T, size_t N>
+  bool sameCurve(const char* name, const T (&expected)[N]){
+    for(size_t i = 0; i < N; i++){
+      if(Curve::table[i] != expected[i]){
+        printf("  error: FadeLedGammaCurve %s step %u is %u, GammaTable.py gives %u\n",
+               name, (unsigned int)i, (unsigned int)Curve::table[i], (unsigned int)expected[i]);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //GammaTable.py 2.8 32 8, 1.8 64 12 and 3 16 16
+  const unsigned int Curve2800x32x8[32] = {
+      0,     1,     1,     2,     3,     4,     6,     8,    11,    14,
+     17,    21,    26,    31,    37,    43,    50,    58,    66,    75,
+     85,    96,   108,   120,   134,   148,   163,   180,   197,   215,
+    235,   255
+  };
+  const unsigned int Curve1800x64x12[64] = {
+      0,     2,     8,    17,    29,    43,    59,    78,   100,   123,
+    149,   177,   207,   239,   273,   309,   347,   387,   429,   473,
+    519,   567,   616,   668,   721,   776,   833,   891,   951,  1013,
+   1077,  1143,  1210,  1279,  1349,  1422,  1495,  1571,  1648,  1727,
+   1808,  1890,  1974,  2059,  2146,  2235,  2325,  2417,  2510,  2605,
+   2701,  2799,  2899,  3000,  3103,  3207,  3313,  3420,  3529,  3639,
+   3751,  3864,  3979,  4095
+  };
+  const unsigned int Curve3000x16x16[16] = {
+      0,    19,   155,   524,  1243,  2427,  4194,  6660,  9942, 14156,
+  19418, 25845, 33554, 42661, 53282, 65535
+  };
+
+  //Checks the compile time tables against the shipped tables and the script
+  bool checkGammaCurves(){
+    bool ok = sameCurve<FadeLedGammaCurve<2300, 101, 8> >("2300/101/8", FadeLedGammaTable8);
+    ok &= sameCurve<FadeLedGammaCurve<2800, 32, 8> >("2800/32/8", Curve2800x32x8);
+    #if FADE_LED_PWM_BITS >= 9
+    ok &= sameCurve<FadeLedGammaCurve<2300, 101, 9> >("2300/101/9", FadeLedGammaTable9);
+    #endif
+    #if FADE_LED_PWM_BITS >= 10
+    ok &= sameCurve<FadeLedGammaCurve<2300, 101, 10> >("2300/101/10", FadeLedGammaTable10);
+    #endif
+    #if FADE_LED_PWM_BITS >= 11
+    ok &= sameCurve<FadeLedGammaCurve<2300, 101, 11> >("2300/101/11", FadeLedGammaTable11);
+    #endif
+    #if FADE_LED_PWM_BITS >= 12
+    ok &= sameCurve<FadeLedGammaCurve<2300, 101, 12> >("2300/101/12", FadeLedGammaTable12);
+    ok &= sameCurve<FadeLedGammaCurve<1800, 64, 12> >("1800/64/12", Curve1800x64x12);
+    #endif
+    #if FADE_LED_PWM_BITS >= 13
+    ok &= sameCurve<FadeLedGammaCurve<2300, 101, 13> >("2300/101/13", FadeLedGammaTable13);
+    #endif
+    #if FADE_LED_PWM_BITS >= 14
+    ok &= sameCurve<FadeLedGammaCurve<2300, 101, 14> >("2300/101/14", FadeLedGammaTable14);
+    #endif
+    #if FADE_LED_PWM_BITS >= 15
+    ok &= sameCurve<FadeLedGammaCurve<2300, 101, 15> >("2300/101/15", FadeLedGammaTable15);
+    #endif
+    #if FADE_LED_PWM_BITS >= 16
+    ok &= sameCurve<FadeLedGammaCurve<2300, 101, 16> >("2300/101/16", FadeLedGammaTable16);
+    ok &= sameCurve<FadeLedGammaCurve<3000, 16, 16> >("3000/16/16", Curve3000x16x16);
+    #endif
+    return ok;
+  }
+  
+  #if FADE_LED_PWM_BITS >= 12
+  //Time of one FadeLedGammaRead() over all steps, in ns
+  double benchGammaRead(const flvar_t* table, byte segmentBits, flvar_t biggestStep){
+    //volatile so the table isn't known at compile time
+    const flvar_t* volatile tableUsed = table;
+    volatile byte segmentBitsUsed = segmentBits;
+    volatile flvar_t sink = 0;
+    
+    unsigned long rounds = minLedTicks / biggestStep + 1;
+    Clock::time_point start = Clock::now();
+    for(unsigned long r = 0; r < rounds; r++){
+      const flvar_t* t = tableUsed;
+      byte bits = segmentBitsUsed;
+      flvar_t sum = 0;
+      for(unsigned long step = 0; step <= biggestStep; step++){
+        sum += FadeLedGammaRead(t, bits, step);
+      }
+      sink = sum;
+    }
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / rounds / (biggestStep + 1);
+  }
+  
+  //Biggest difference between a compressed table and the full table
+  unsigned int gammaMaxError(const flvar_t* full, const flvar_t* pwl, byte segmentBits, flvar_t biggestStep){
+    unsigned int maxError = 0;
+    for(unsigned long step = 0; step <= biggestStep; step++){
+      long diff = (long)FadeLedGammaRead(pwl, segmentBits, step) - (long)FadeLedGammaRead(full, 0, step);
+      if(diff < 0){
+        diff = -diff;
+      }
+      if((unsigned int)diff > maxError){
+        maxError = diff;
+      }
+    }
+    return maxError;
+  }
+  
+  template <class Curve>
+  void printGammaPwl(const flvar_t* full){
+    printf("%-8s %6u %10u %10u %12.2f\n", "pwl", 1U << Curve::SegmentBits,
+           (unsigned int)sizeof(Curve::table), gammaMaxError(full, Curve::table, Curve::SegmentBits, Curve::BiggestStep),
+           benchGammaRead(Curve::table, Curve::SegmentBits, Curve::BiggestStep));
+  }
+  
+  //Flash use, error and lookup time of 4097 step (gamma 2.3) tables, full and compressed
+  void benchGamma(){
+    //the full table is calculated at run time, as FadeLedGammaCurve it takes long to compile
+    const unsigned int Steps = 4097;
+    const unsigned long Top = (1UL << FADE_LED_PWM_BITS) - 1;
+    const unsigned long Skip = FadeLedGammaMath::leadingZero(Steps, 2.3, Top);
+    static flvar_t full[Steps];
+    for(unsigned int i = 0; i < Steps; i++){
+      full[i] = FadeLedGammaMath::level(i + Skip, Steps + Skip, 2.3, Top);
+    }
+    
+    printf("\n%-8s %6s %10s %10s %12s\n", "gamma", "seg", "bytes", "max error", "ns/lookup");
+    printf("%-8s %6u %10u %10u %12.2f\n", "full", 1U, (unsigned int)sizeof(full), 0U,
+           benchGammaRead(full, 0, Steps - 1));
+    printGammaPwl<FadeLedGammaPwlCurve<2300, Steps, 4> >(full);
+    printGammaPwl<FadeLedGammaPwlCurve<2300, Steps, 5> >(full);
+    printGammaPwl<FadeLedGammaPwlCurve<2300, Steps, 6> >(full);
+    printGammaPwl<FadeLedGammaPwlCurve<2300, Steps, 7> >(full);
+  }
+  #endif
+  
+  //Cost of a tick (ns) when all LEDs are done fading or when only one is fading
+  double benchIdle(unsigned int count, bool oneFading){
+    std::vector<FadeLed*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(new FadeLed(i & 0xFF));
+      leds.back()->setTime(FadeTime);
+    }
+    tick();
+    tick();
+    
+    unsigned long ticks = minLedTicks / 20;
+    double ns = 0;
+    for(unsigned long done = 0; done < ticks; done += TicksPerFade){
+      if(oneFading){
+        if(leds[0]->get()){
+          leds[0]->off();
+        }
+        else{
+          leds[0]->on();
+        }
+      }
+      ns += runFade(TicksPerFade);
+    }
+    
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return ns / ticks;
+  }
+  
+  //Cost of an update (ns) that finds the finished fades, by polling done() of all LEDs or with FadeLed::completed()
+  //The LEDs fade up one after the other, the next starts when the fade before finished
+  double benchReact(unsigned int count, bool useCompleted){
+    std::vector<FadeLed*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(new FadeLed(i & 0xFF));
+      leds.back()->setTime(FadeTime);
+    }
+    tick();
+    tick();
+    
+    unsigned long ticks = minLedTicks / 20;
+    unsigned int fading = 0;
+    unsigned long finished = 0;
+    leds[0]->on();
+    
+    Clock::time_point start = Clock::now();
+    for(unsigned long i = 0; i < ticks; i++){
+      FadeLedHal::advance(Interval);
+      FadeLed* led = nullptr;
+      if(useCompleted){
+        if(FadeLed::update()){
+          led = FadeLed::completed();
+        }
+      }
+      else{
+        FadeLed::update();
+        for(unsigned int j = 0; j < count; j++){
+          if(leds[j]->done() && leds[j]->getCurrent()){
+            led = leds[j];
+          }
+        }
+      }
+      
+      if(led){
+        finished++;
+        led->begin(0);
+        fading = (fading + 1) % count;
+        leds[fading]->on();
+      }
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    
+    if(finished < ticks / (2 * TicksPerFade)){
+      printf("  warning: only %lu fades finished\n", finished);
+    }
+    
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return ns / ticks;
+  }
+  
+  #if FADE_LED_RETARGET
+  struct RetargetResult{
+    unsigned long doneMs;
+    long kink;
+  };
+  
+  //A control loop that sets a new brightness every tick: a constant time fade up is turned back down halfway
+  //Gives the ms from the new brightness until it's reached and the biggest change of speed (steps per tick) of the whole fade
+  RetargetResult benchRetarget(byte mode){
+    FadeLed led(0);
+    led.noGammaTable();
+    led.setTime(FadeTime, true);
+    led.setRetarget(mode);
+    tick();
+    tick();
+    
+    const flvar_t top = led.getBiggestStep();
+    const flvar_t target = top / 4;
+    led.set(top);
+    
+    RetargetResult res = {0, 0};
+    long last = 0;
+    long speed = 0;
+    unsigned long start = 0;
+    for(unsigned long i = 1; i < 4 * TicksPerFade; i++){
+      if(i > TicksPerFade / 2){
+        if(!start){
+          start = millis();
+        }
+        led.set(target);
+      }
+      tick();
+      
+      long now = led.getCurrent();
+      long newSpeed = now - last;
+      if(i > 1 && labs(newSpeed - speed) > res.kink){
+        res.kink = labs(newSpeed - speed);
+      }
+      speed = newSpeed;
+      last = now;
+      
+      if(start && now == target){
+        res.doneMs = millis() - start;
+        break;
+      }
+    }
+    return res;
+  }
+  #endif
+  
+  #if FADE_LED_STATS
+  //Counters of 100 LEDs fading up and down (a step every other tick), with update() called every few intervals
+  //Next to them a group, a core and layers, their writes must be counted too. Returns false if the writes don't match
+  bool benchStats(unsigned int every){
+    std::vector<FadeLed*> leds;
+    for(unsigned int i = 0; i < 100; i++){
+      leds.push_back(new FadeLed(i));
+      leds.back()->setTime(FadeTime * 5);
+    }
+    FadeLedGroup<3> group({100, 101, 102});
+    group.setTime(FadeTime);
+    FadeLedCore<> core(103);
+    core.setTime(FadeTime);
+    FadeLedLayers<2> layers(104);
+    layers.setTime(0, FadeTime);
+    const flvar_t GroupOn[3] = {100, 50, 25};
+    const flvar_t GroupOff[3] = {0, 0, 0};
+    tick();
+    tick();
+    
+    FadeLed::resetStats();
+    FadeLedHal::resetWrites();
+    for(unsigned long i = 0; i < 4 * TicksPerFade; i += every){
+      if(i % (2 * TicksPerFade) == 0){
+        for(size_t j = 0; j < leds.size(); j++){
+          leds[j]->on();
+        }
+        group.set(GroupOn);
+        core.on();
+        layers.set(0, layers.getBiggestStep());
+      }
+      else if(i % (2 * TicksPerFade) == TicksPerFade){
+        for(size_t j = 0; j < leds.size(); j++){
+          leds[j]->off();
+        }
+        group.set(GroupOff);
+        core.off();
+        layers.set(0, 0);
+      }
+      FadeLedHal::advance(every * Interval);
+      FadeLed::update();
+    }
+    
+    FadeLedStats stats = FadeLed::stats();
+    printf("%-8s %6u %8lu %8lu %8lu %8lu %8lu %10.2f %8lu %10.2f %10lu\n", "update", every,
+           stats.updates, stats.ticks, stats.lateTicks, stats.resyncs, stats.skippedIntervals,
+           (double)stats.ledsUpdated / stats.ticks, stats.ledsUpdatedMax,
+           (double)stats.writes / stats.ticks, stats.writesSkipped);
+    bool same = (stats.writes == FadeLedHal::writes());
+    if(!same){
+      printf("  WRONG: %lu writes counted, %lu done\n", stats.writes, FadeLedHal::writes());
+    }
+    
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return same;
+  }
+  #endif
+  
+  #if FADE_LED_TRACE
+  //Writes what FadeLedTrace::dump() sends to a file
+  struct FileOut{
+    FILE* file;
+    
+    size_t write(const uint8_t* buffer, size_t size){
+      return fwrite(buffer, 1, size, file);
+    }
+  };
+  
+  //Records a few fades (also of a group), with every 10th update() two intervals late, and dumps the trace to a file
+  bool writeTrace(const char* name){
+    FadeLed speed(0);
+    speed.setTime(FadeTime);
+    FadeLed time(1);
+    time.setTime(FadeTime / 2, true);
+    FadeLed full(2);
+    full.noGammaTable();
+    full.setTime(FadeTime * 3 / 4, true);
+    //goes to the trace the same way
+    FadeLedGroup<2> group({3, 4});
+    group.setTime(FadeTime / 2);
+    const flvar_t GroupOn[2] = {80, 40};
+    tick();
+    tick();
+    FadeLedTrace::clear();
+    
+    for(unsigned long i = 0; i < 3 * TicksPerFade; i++){
+      if(i == 0){
+        speed.on();
+        time.set(60);
+        group.set(GroupOn);
+      }
+      else if(i == TicksPerFade / 2){
+        full.set(full.getBiggestStep());
+      }
+      else if(i == TicksPerFade + 5){
+        speed.off();
+        time.set(20);
+      }
+      FadeLedHal::advance(Interval * ((i % 10 == 9) ? 3 : 1));
+      FadeLed::update();
+    }
+    
+    FileOut out = {fopen(name, "wb")};
+    if(!out.file){
+      printf("can't write %s\n", name);
+      return false;
+    }
+    FadeLedTrace::dump(out);
+    fclose(out.file);
+    printf("%u records written to %s\n", FadeLedTrace::count(), name);
+    return true;
+  }
+  #endif
+  
+  #if FADE_LED_COMPACT
+  //Fills the list of gamma tables (the default table with other biggest steps are other tables), what doesn't fit must
+  //be reported and leave the table the object has. Fills the list for good, so run it last
+  bool checkGammaTablesFull(){
+    FadeLed led(0);
+    bool ok = !FadeLed::gammaTablesFull();
+    flvar_t biggest = led.getBiggestStep();
+    bool full = false;
+    for(flvar_t i = 0; i < FADE_LED_GAMMA_TABLES; i++){
+      if(led.setGammaTable(FadeLedGammaTable, 10 + i)){
+        ok &= !full && led.getBiggestStep() == 10 + i;
+        biggest = 10 + i;
+      }
+      else{
+        full = true;
+        ok &= led.getBiggestStep() == biggest;
+      }
+    }
+    ok &= full && FadeLed::gammaTablesFull();
+    
+    //a constructor that doesn't find a place takes the default table
+    FadeLed other(1, FadeLedGammaTable, 99);
+    ok &= other.getBiggestStep() == 100;
+    return ok;
+  }
+  #endif
+  
+  struct BamResult{
+    double nsPerPlane;
+    double nsPerFlush;
+    bool dutyOk;
+  };
+  
+  //Software PWM on the pins 0 to Channels - 1 (8 per port), random levels
+  template <byte Channels>
+  BamResult benchBam(){
+    byte pins[Channels];
+    for(byte i = 0; i < Channels; i++){
+      pins[i] = i;
+    }
+    FadeLedBam<Channels, (Channels + 7) / 8> bam(pins);
+    bam.begin();
+    
+    BamResult res;
+    const unsigned int Flushes = 2000;
+    std::vector<flvar_t> levels(Flushes * Channels);
+    srand(Channels);
+    for(size_t i = 0; i < levels.size(); i++){
+      levels[i] = rand() % (FADE_LED_RESOLUTION + 1);
+    }
+    Clock::time_point start = Clock::now();
+    for(unsigned int f = 0; f < Flushes; f++){
+      for(byte i = 0; i < Channels; i++){
+        bam.write(i, levels[f * Channels + i]);
+      }
+      FadeLedOutput::flushAll();
+    }
+    res.nsPerFlush = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / Flushes;
+    
+    //takes the last frame on the first cycle, check the time each pin is on the second
+    const byte Bits = bam.getBits();
+    unsigned long onTime[Channels] = {};
+    for(byte cycle = 0; cycle < 2; cycle++){
+      for(byte b = 0; b < Bits; b++){
+        unsigned int units = bam.isr();
+        for(byte i = 0; i < Channels && cycle; i++){
+          if(FadeLedHal::digitalValue(pins[i])){
+            onTime[i] += units;
+          }
+        }
+      }
+    }
+    res.dutyOk = true;
+    for(byte i = 0; i < Channels; i++){
+      res.dutyOk &= onTime[i] == (unsigned long)bam.read(i) >> (FADE_LED_PWM_BITS - Bits);
+    }
+    
+    const unsigned long Planes = 4000000UL;
+    start = Clock::now();
+    for(unsigned long i = 0; i < Planes; i++){
+      bam.isr();
+    }
+    res.nsPerPlane = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / Planes;
+    return res;
+  }
+  
+  //FadeLed with the same table as the FadeLedCore it's compared with
+  template <class Led>
+  Led* makeLed(byte pin, bool gamma){
+    return new Led(pin);
+  }
+  
+  template <>
+  FadeLed* makeLed<FadeLed>(byte pin, bool gamma){
+    return new FadeLed(pin, gamma);
+  }
+  
+  //Scaled FadeLedPolicyLinear against the exact division: at most one level up, the biggest step the biggest level
+  template <byte Bits, unsigned long Steps>
+  bool checkLinear(){
+    typedef FadeLedPolicyLinear::Curve<Bits, Steps> Curve;
+    for(unsigned long step = 0; step < Steps; step++){
+      unsigned long exact = step * ((1UL << Bits) - 1) / (Steps - 1);
+      unsigned long level = Curve::read(step);
+      if(level < exact || level > exact + 1){
+        return false;
+      }
+    }
+    return Curve::read(Steps - 1) == (1UL << Bits) - 1;
+  }
+  
+  //Same fades as speed and time on FadeLed objects or on FadeLedCore objects, the checksum must match
+  template <class Led>
+  Result benchCore(unsigned int count, bool constTime, bool gamma){
+    std::vector<Led*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(makeLed<Led>(i & 0xFF, gamma));
+      leds.back()->setTime(FadeTime, constTime);
+    }
+    //same start time for both, the checksum includes the time
+    FadeLedHal::setMillis(1000000UL);
+    tick();
+    tick();
+    
+    unsigned long rounds = minLedTicks / (2 * TicksPerFade * count);
+    if(rounds == 0){
+      rounds = 1;
+    }
+    
+    FadeLedHal::resetWrites();
+    double ns = 0;
+    for(unsigned long r = 0; r < rounds; r++){
+      for(unsigned int i = 0; i < count; i++){
+        if(constTime){
+          leds[i]->set(1 + (i * 37UL) % leds[i]->getBiggestStep());
+        }
+        else{
+          leds[i]->on();
+        }
+      }
+      ns += runFade(TicksPerFade);
+      
+      for(unsigned int i = 0; i < count; i++){
+        leds[i]->off();
+      }
+      ns += runFade(TicksPerFade);
+    }
+    
+    Result res;
+    unsigned long ticks = rounds * 2 * TicksPerFade;
+    res.nsPerLedTick = ns / ticks / count;
+    res.writesPerTick = (double)FadeLedHal::writes() / ticks;
+    res.hash = FadeLedHal::writeHash();
+    
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return res;
+  }
+  
+  struct SceneResult{
+    double nsLoop;
+    double nsScene;
+    bool same;
+  };
+  
+  //Switching all LEDs between two scenes, with setTime() and set() on each or with one FadeLedScene::fade()
+  SceneResult benchScene(unsigned int count){
+    std::vector<flvar_t> levels[2];
+    for(unsigned int i = 0; i < count; i++){
+      levels[0].push_back(1 + (i * 37UL) % 100);
+      levels[1].push_back((i * 11UL) % 101);
+    }
+    
+    SceneResult res = {0, 0, false};
+    unsigned long hash[2];
+    for(int useScene = 0; useScene < 2; useScene++){
+      std::vector<FadeLed*> leds;
+      for(unsigned int i = 0; i < count; i++){
+        leds.push_back(new FadeLed(i & 0xFF));
+      }
+      FadeLedScene scenes[2] = {FadeLedScene(&leds[0], &levels[0][0], count, false), FadeLedScene(&leds[0], &levels[1][0], count, false)};
+      //same start time for both, the checksum includes the time
+      FadeLedHal::setMillis(1000000UL);
+      tick();
+      tick();
+      
+      unsigned long rounds = minLedTicks / (2 * TicksPerFade * count);
+      if(rounds == 0){
+        rounds = 1;
+      }
+      
+      FadeLedHal::resetWrites();
+      double ns = 0;
+      for(unsigned long r = 0; r < rounds * 2; r++){
+        int scene = r % 2;
+        Clock::time_point start = Clock::now();
+        if(useScene){
+          scenes[scene].fade(FadeTime);
+        }
+        else{
+          for(unsigned int i = 0; i < count; i++){
+            leds[i]->setTime(FadeTime, true);
+            leds[i]->set(levels[scene][i]);
+          }
+        }
+        ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        runFade(TicksPerFade + 1);
+      }
+      
+      (useScene ? res.nsScene : res.nsLoop) = ns / (rounds * 2) / count;
+      hash[useScene] = FadeLedHal::writeHash();
+      for(size_t i = 0; i < leds.size(); i++){
+        delete leds[i];
+      }
+    }
+    res.same = hash[0] == hash[1];
+    return res;
+  }
+  
+  #if FADE_LED_MASTER
+  enum MasterMode{
+    NoMaster,
+    MasterFull,
+    MasterFading
+  };
+  
+  struct MasterResult{
+    double nsPerLedTick;
+    uint32_t hash;
+    bool ok;
+  };
+  
+  //Output level of a LED with a master of the scale, worked out on its own
+  long dimmedReference(FadeLed* led, uint32_t scale){
+    if(scale == FadeLedMaster::One){
+      return led->getGammaValue(led->getCurrent());
+    }
+    unsigned long pos = ((unsigned long)led->getCurrent() << 8) * (scale >> 8) >> 8;
+    long low = led->getGammaValue(pos >> 8);
+    long high = led->getGammaValue((pos >> 8) + 1);
+    return ((low << 8) + (long)(pos & 0xFF) * (high - low) + 0x80) >> 8;
+  }
+  
+  //Speed fades with every LED in a zone under a global master, the global master fading or not
+  MasterResult benchMaster(unsigned int count, MasterMode mode){
+    FadeLedMaster global;
+    FadeLedMaster zone(&global);
+    global.setTime(FadeTime);
+    
+    std::vector<FadeLed*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(new FadeLed(i & 0xFF));
+      leds.back()->setTime(FadeTime);
+      if(mode != NoMaster){
+        leds.back()->setMaster(&zone);
+      }
+    }
+    if(mode == MasterFading){
+      zone.begin(200);
+    }
+    //same start time for all, the checksum includes the time
+    FadeLedHal::setMillis(1000000UL);
+    tick();
+    tick();
+    
+    unsigned long rounds = minLedTicks / (2 * TicksPerFade * count);
+    if(rounds == 0){
+      rounds = 1;
+    }
+    
+    FadeLedHal::resetWrites();
+    MasterResult res = {0, 0, true};
+    double ns = 0;
+    for(unsigned long r = 0; r < rounds * 2; r++){
+      for(unsigned int i = 0; i < count; i++){
+        if(r % 2){
+          leds[i]->off();
+        }
+        else{
+          leds[i]->on();
+        }
+      }
+      if(mode == MasterFading){
+        global.set((r % 2) ? FadeLedMaster::Full : 64);
+      }
+      
+      for(unsigned long t = 0; t < TicksPerFade; t++){
+        Clock::time_point start = Clock::now();
+        tick();
+        ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        
+        //every pin its own LED, check each shows its brightness with the masters
+        if(count <= 256){
+          for(unsigned int i = 0; i < count; i++){
+            if(FadeLedHal::lastValue(i) != dimmedReference(leds[i], mode == NoMaster ? FadeLedMaster::One : zone.getScale())){
+              res.ok = false;
+            }
+          }
+        }
+      }
+    }
+    
+    res.nsPerLedTick = ns / (rounds * 2 * TicksPerFade) / count;
+    res.hash = FadeLedHal::writeHash();
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return res;
+  }
+  #endif
+  
+  struct LayersResult{
+    double nsPerLedTick;
+    uint32_t hash;
+    bool ok;
+  };
+  
+  //Blend of the layers of a pin worked out on its own, layer k is set after the layers below it each round
+  flvar_t layersReference(FadeLedLayersBase* led, const FadeLedLayersBase::Blend* blends, const bool* active, byte count){
+    unsigned long out = 0;
+    for(byte k = 0; k < count; k++){
+      if(!active[k]){
+        continue;
+      }
+      unsigned long cur = led->getCurrent(k);
+      if(k == 0 || blends[k] == FadeLedLayersBase::BlendLatest){
+        out = cur;
+      }
+      else if(blends[k] == FadeLedLayersBase::BlendAdd){
+        out = (out + cur > led->getBiggestStep()) ? led->getBiggestStep() : out + cur;
+      }
+      else if(cur > out){
+        out = cur;
+      }
+    }
+    return out;
+  }
+  
+  //Speed fades on the bottom layer of each pin, the layers above fade in constant time with each blend mode in turn and the top one is released now and then
+  template <byte Layers>
+  LayersResult benchLayers(unsigned int count){
+    const FadeLedLayersBase::Blend Modes[3] = {FadeLedLayersBase::BlendHighest, FadeLedLayersBase::BlendAdd, FadeLedLayersBase::BlendLatest};
+    FadeLedLayersBase::Blend blends[Layers];
+    bool active[Layers];
+    std::vector<FadeLedLayers<Layers>*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(new FadeLedLayers<Layers>(i & 0xFF));
+      //the pin may still show the last run
+      leds.back()->begin(0, 0);
+      leds.back()->setTime(0, FadeTime);
+      for(byte k = 1; k < Layers; k++){
+        blends[k] = Modes[(k - 1) % 3];
+        leds.back()->setTime(k, FadeTime / 2 + k * Interval, true);
+        leds.back()->setBlend(k, blends[k]);
+      }
+    }
+    for(byte k = 0; k < Layers; k++){
+      active[k] = (k == 0);
+    }
+    //same start time as the FadeLed run, the checksum includes the time
+    FadeLedHal::setMillis(1000000UL);
+    tick();
+    tick();
+    
+    unsigned long rounds = minLedTicks / (2 * TicksPerFade * count);
+    if(rounds == 0){
+      rounds = 1;
+    }
+    
+    FadeLedHal::resetWrites();
+    LayersResult res = {0, 0, true};
+    double ns = 0;
+    for(unsigned long r = 0; r < rounds * 2; r++){
+      for(unsigned int i = 0; i < count; i++){
+        leds[i]->set(0, (r % 2) ? 0 : leds[i]->getBiggestStep());
+        for(byte k = 1; k < Layers; k++){
+          //never the same brightness twice in a row, so each set() counts as the latest
+          leds[i]->set(k, ((r + k) % 2) ? (i * 37UL + k * 11) % 50 : 50 + (i * 13UL + k) % 51);
+        }
+      }
+      for(byte k = 1; k < Layers; k++){
+        active[k] = true;
+      }
+      
+      for(unsigned long t = 0; t < TicksPerFade; t++){
+        if(Layers > 1 && r % 4 == 3 && t == TicksPerFade / 2){
+          for(unsigned int i = 0; i < count; i++){
+            leds[i]->release(Layers - 1);
+          }
+          active[Layers - 1] = false;
+        }
+        
+        Clock::time_point start = Clock::now();
+        tick();
+        ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        
+        //every pin its own object, check each shows the blend of its layers
+        if(count <= 256){
+          for(unsigned int i = 0; i < count; i++){
+            flvar_t ref = layersReference(leds[i], blends, active, Layers);
+            if(leds[i]->getOutput() != ref || FadeLedHal::lastValue(i) != FadeLedGammaRead(FadeLedGammaTable, 0, ref)){
+              res.ok = false;
+            }
+          }
+        }
+      }
+    }
+    
+    res.nsPerLedTick = ns / (rounds * 2 * TicksPerFade) / count;
+    res.hash = FadeLedHal::writeHash();
+    
+    //a layer that isn't there may not touch the ones that are
+    flvar_t output = leds[0]->getOutput();
+    leds[0]->begin(Layers, 10);
+    leds[0]->set(Layers, 20);
+    leds[0]->setTime(Layers, FadeTime);
+    leds[0]->setBlend(Layers, FadeLedLayersBase::BlendAdd);
+    leds[0]->release(Layers);
+    if(leds[0]->get(Layers) != 0 || leds[0]->getCurrent(Layers) != 0 || leds[0]->getOutput() != output){
+      res.ok = false;
+    }
+    
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return res;
+  }
+  
+  //The same speed fades on FadeLed objects, to compare the checksum and cost of one layer
+  LayersResult benchLayersBase(unsigned int count){
+    std::vector<FadeLed*> leds;
+    for(unsigned int i = 0; i < count; i++){
+      leds.push_back(new FadeLed(i & 0xFF));
+      leds.back()->setTime(FadeTime);
+    }
+    FadeLedHal::setMillis(1000000UL);
+    tick();
+    tick();
+    
+    unsigned long rounds = minLedTicks / (2 * TicksPerFade * count);
+    if(rounds == 0){
+      rounds = 1;
+    }
+    
+    FadeLedHal::resetWrites();
+    LayersResult res = {0, 0, true};
+    for(unsigned long r = 0; r < rounds * 2; r++){
+      for(unsigned int i = 0; i < count; i++){
+        leds[i]->set((r % 2) ? 0 : leds[i]->getBiggestStep());
+      }
+      res.nsPerLedTick += runFade(TicksPerFade);
+    }
+    
+    res.nsPerLedTick = res.nsPerLedTick / (rounds * 2 * TicksPerFade) / count;
+    res.hash = FadeLedHal::writeHash();
+    for(size_t i = 0; i < leds.size(); i++){
+      delete leds[i];
+    }
+    return res;
+  }
+  
+  struct LateResult{
+    unsigned long ledMs;
+    unsigned long groupMs;
+  };
+  
+  //Time (ms) a constant time fade takes when update() is only called every few intervals, starting just before millis() rolls over
+  LateResult benchLate(unsigned int every){
+    FadeLedHal::setMillis((unsigned long)-(FadeTime / 2));
+    tick();
+    tick();
+    
+    FadeLed led(0);
+    led.setTime(FadeTime, true);
+    FadeLedGroup<3> group({1, 2, 3});
+    group.setTime(FadeTime);
+    
+    unsigned long start = millis();
+    const flvar_t color[3] = {led.getBiggestStep(), 1, 0};
+    led.set(led.getBiggestStep());
+    group.set(color);
+    
+    LateResult res = {0, 0};
+    //give up at 100 times the fade time
+    while(!(res.ledMs && res.groupMs) && millis() - start < 100 * FadeTime){
+      FadeLedHal::advance(every * Interval);
+      FadeLed::update();
+      if(!res.ledMs && led.done()){
+        res.ledMs = millis() - start;
+      }
+      if(!res.groupMs && group.done()){
+        res.groupMs = millis() - start;
+      }
+    }
+    return res;
+  }
+}
+
+int main(int argc, char* argv[]){
+  for(int i = 1; i < argc; i++){
+    if(!strcmp(argv[i], "--quick")){
+      minLedTicks = 100000UL;
+    }
+  }
+
+  FadeLed::setInterval(Interval);
+  
+  #if FADE_LED_TRACE
+  //only the trace
+  for(int i = 1; i < argc - 1; i++){
+    if(!strcmp(argv[i], "--trace")){
+      return writeTrace(argv[i + 1]) ? 0 : 1;
+    }
+  }
+  #endif
+
+  printf("FadeLed host benchmark: FADE_LED_PWM_BITS = %d, FADE_LED_RESOLUTION = %ld, %s engine\n",
+         FADE_LED_PWM_BITS, (long)FADE_LED_RESOLUTION, FADE_LED_INCREMENTAL ? "incremental" : "division");
+  printf("FadeLed object: %u bytes on this host%s\n", (unsigned int)sizeof(FadeLed), FADE_LED_COMPACT ? " (compact)" : "");
+  if(!checkGammaCurves()){
+    return 1;
+  }
+  printf("FadeLedGammaCurve matches GammaTable.py\n\n");
+  
+  //false once a table prints DIFFERS or WRONG
+  bool ok = true;
+  
+  printf("%-8s %6s %14s %12s %10s\n", "mode", "leds", "ns/led/tick", "writes/tick", "checksum");
+
+  for(int mode = 0; mode < NrModes; mode++){
+    if((mode == Dither && !FADE_LED_DITHER) || (mode == Ease && !FADE_LED_EASING)){
+      continue;
+    }
+    for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+      Result res = benchFades(LedCounts[c], (Mode)mode);
+      printf("%-8s %6u %14.2f %12.2f   %08lx\n", ModeNames[mode],
+             LedCounts[c], res.nsPerLedTick, res.writesPerTick, (unsigned long)res.hash);
+    }
+  }
+  
+  printf("\n%-8s %6s %14s %12s %10s   (%s)\n", "slow", "leds", "ns/led/tick", "writes/tick", "checksum",
+         FADE_LED_SCHEDULER ? "scheduler" : "every tick");
+  for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+    Result res = benchSlow(LedCounts[c]);
+    printf("%-8s %6u %14.2f %12.2f   %08lx\n", "speed", LedCounts[c],
+           res.nsPerLedTick, res.writesPerTick, (unsigned long)res.hash);
+  }
+  
+  printf("\n%-8s %6s %14s %12s %10s\n", "sequence", "leds", "ns/led/tick", "writes/tick", "checksum");
+  for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+    Result res = benchSequence(LedCounts[c]);
+    printf("%-8s %6u %14.2f %12.2f   %08lx\n", "pattern", LedCounts[c],
+           res.nsPerLedTick, res.writesPerTick, (unsigned long)res.hash);
+  }
+  
+  printf("\n%-8s %6s %14s %12s %12s\n", "output", "leds", "ns/led/tick", "trans/tick", "chan/tick");
+  for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+    OutputResult res = benchOutput(LedCounts[c]);
+    printf("%-8s %6u %14.2f %12.2f %12.2f\n", "mock", LedCounts[c],
+           res.nsPerLedTick, res.transactionsPerTick, res.channelsPerTick);
+  }
+  
+  printf("\n%-8s %6s %14s %14s\n", "rgb", "lights", "separate", "group");
+  for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+    printf("%-8s %6u %14.2f %14.2f\n", "ns/ch", LedCounts[c],
+           benchGroup(LedCounts[c], false), benchGroup(LedCounts[c], true));
+  }
+  bool setTimeOk = checkGroupSetTime(FadeTime / 8) && checkGroupSetTime(FadeTime * 3 / 4) && checkGroupSetTime(FadeTime * 2);
+  printf("%-8s %6s %14s %14s\n", "setTime", "", "", setTimeOk ? "ok" : "WRONG");
+  ok &= setTimeOk;
+  
+  #if FADE_LED_PWM_BITS >= 12
+  benchGamma();
+  #endif
+  
+  printf("\n%-8s %6s %14s\n", "idle", "leds", "ns/tick");
+  for(int oneFading = 0; oneFading < 2; oneFading++){
+    for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+      printf("%-8s %6u %14.2f\n", oneFading ? "1 fading" : "none",
+             LedCounts[c], benchIdle(LedCounts[c], oneFading));
+    }
+  }
+  
+  printf("\n%-8s %6s %14s %14s\n", "react", "leds", "poll done()", "completed()");
+  for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+    printf("%-8s %6u %14.2f %14.2f\n", "ns/tick", LedCounts[c],
+           benchReact(LedCounts[c], false), benchReact(LedCounts[c], true));
+  }
+  
+  #if FADE_LED_RETARGET
+  const char* const RetargetNames[] = {"ignore", "restart", "remain"};
+  printf("\n%-8s %10s %10s   (fade of %lums, turned back halfway)\n", "retarget", "done ms", "kink",
+         FadeTime);
+  for(byte mode = FadeLed::RetargetIgnore; mode <= FadeLed::RetargetRemaining; mode++){
+    RetargetResult res = benchRetarget(mode);
+    printf("%-8s %10lu %10ld\n", RetargetNames[mode], res.doneMs, res.kink);
+  }
+  #endif
+  
+  #if FADE_LED_STATS
+  printf("\n%-8s %6s %8s %8s %8s %8s %8s %10s %8s %10s %10s\n", "stats", "every", "updates", "ticks", "late",
+         "resyncs", "skipped", "leds/tick", "max", "writes/t", "unchanged");
+  ok &= benchStats(1);
+  ok &= benchStats(3);
+  #endif
+  
+  printf("\n%-8s %6s %6s %10s %10s %8s   (8 bits)\n", "bam", "pins", "ports", "ns/plane", "ns/flush", "duty");
+  const BamResult bam[] = {benchBam<8>(), benchBam<24>(), benchBam<48>(), benchBam<96>()};
+  const byte BamPins[] = {8, 24, 48, 96};
+  for(byte i = 0; i < sizeof(BamPins); i++){
+    printf("%-8s %6u %6u %10.2f %10.2f %8s\n", "isr", BamPins[i], (BamPins[i] + 7) / 8,
+           bam[i].nsPerPlane, bam[i].nsPerFlush, bam[i].dutyOk ? "ok" : "WRONG");
+    ok &= bam[i].dutyOk;
+  }
+  
+  typedef FadeLedCore<FADE_LED_PWM_BITS, 101, FadeLedPolicyGamma<2300> > CoreGamma;
+  typedef FadeLedCore<FADE_LED_PWM_BITS, FADE_LED_RESOLUTION + 1UL, FadeLedPolicyLinear> CoreLinear;
+  printf("\n%-8s %-7s %6s %12s %12s %8s   (ns/led/tick)\n", "core", "table", "leds", "FadeLed", "FadeLedCore", "output");
+  for(int gamma = 1; gamma >= 0; gamma--){
+    for(int constTime = 0; constTime < 2; constTime++){
+      for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+        Result led = benchCore<FadeLed>(LedCounts[c], constTime, gamma);
+        Result core = gamma ? benchCore<CoreGamma>(LedCounts[c], constTime, gamma) :
+                              benchCore<CoreLinear>(LedCounts[c], constTime, gamma);
+        printf("%-8s %-7s %6u %12.2f %12.2f %8s\n", ModeNames[constTime ? Time : Speed], gamma ? "gamma" : "linear",
+               LedCounts[c], led.nsPerLedTick, core.nsPerLedTick, led.hash == core.hash ? "same" : "DIFFERS");
+        ok &= led.hash == core.hash;
+      }
+    }
+  }
+  
+  bool linearOk = checkLinear<8, 101>() && checkLinear<FADE_LED_PWM_BITS, 101>() && checkLinear<FADE_LED_PWM_BITS, (1UL << FADE_LED_PWM_BITS) - 1>() &&
+                  checkLinear<FADE_LED_PWM_BITS, 2>();
+  printf("%-8s %-7s %6s %12s %12s %8s\n", "scaled", "linear", "", "", "", linearOk ? "ok" : "WRONG");
+  ok &= linearOk;
+  
+  printf("\n%-8s %6s %14s %14s %8s   (ns/led to start a crossfade)\n", "scene", "leds", "set() each", "scene fade()", "output");
+  for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+    SceneResult res = benchScene(LedCounts[c]);
+    printf("%-8s %6u %14.2f %14.2f %8s\n", "switch", LedCounts[c], res.nsLoop, res.nsScene, res.same ? "same" : "DIFFERS");
+    ok &= res.same;
+  }
+  
+  #if FADE_LED_MASTER
+  printf("\n%-8s %6s %12s %12s %12s %8s %8s   (ns/led/tick)\n", "master", "leds", "none", "full", "fading", "output", "dimmed");
+  for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+    MasterResult none = benchMaster(LedCounts[c], NoMaster);
+    MasterResult full = benchMaster(LedCounts[c], MasterFull);
+    MasterResult fading = benchMaster(LedCounts[c], MasterFading);
+    printf("%-8s %6u %12.2f %12.2f %12.2f %8s %8s\n", "zone", LedCounts[c], none.nsPerLedTick, full.nsPerLedTick,
+           fading.nsPerLedTick, none.hash == full.hash ? "same" : "DIFFERS", (none.ok && full.ok && fading.ok) ? "ok" : "WRONG");
+    ok &= none.hash == full.hash && none.ok && full.ok && fading.ok;
+  }
+  #endif
+  
+  printf("\n%-8s %6s %10s %10s %10s %10s %10s %8s %8s   (ns/pin/tick)\n", "layers", "leds", "FadeLed", "1 layer", "2 layers",
+         "4 layers", "8 layers", "output", "blend");
+  for(size_t c = 0; c < sizeof(LedCounts) / sizeof(LedCounts[0]); c++){
+    LayersResult base = benchLayersBase(LedCounts[c]);
+    LayersResult one = benchLayers<1>(LedCounts[c]);
+    LayersResult two = benchLayers<2>(LedCounts[c]);
+    LayersResult four = benchLayers<4>(LedCounts[c]);
+    LayersResult eight = benchLayers<8>(LedCounts[c]);
+    printf("%-8s %6u %10.2f %10.2f %10.2f %10.2f %10.2f %8s %8s\n", "blend", LedCounts[c], base.nsPerLedTick, one.nsPerLedTick,
+           two.nsPerLedTick, four.nsPerLedTick, eight.nsPerLedTick, base.hash == one.hash ? "same" : "DIFFERS",
+           (one.ok && two.ok && four.ok && eight.ok) ? "ok" : "WRONG");
+    ok &= base.hash == one.hash && one.ok && two.ok && four.ok && eight.ok;
+  }
+  
+  //last, it moves the clock to the roll over of millis()
+  const unsigned int LateEvery[] = {1, 3, 10, 37};
+  printf("\n%-8s %6s %10s %10s   (fade of %lums, %s)\n", "late", "every", "led ms", "group ms",
+         FadeTime, FADE_LED_ELAPSED_TIME ? "elapsed time" : "counting updates");
+  for(size_t c = 0; c < sizeof(LateEvery) / sizeof(LateEvery[0]); c++){
+    LateResult res = benchLate(LateEvery[c]);
+    printf("%-8s %6u %10lu %10lu\n", "update", LateEvery[c], res.ledMs, res.groupMs);
+  }
+  
+  #if FADE_LED_COMPACT
+  bool tablesOk = checkGammaTablesFull();
+  printf("\n%-8s %6u %8s\n", "gamma", FADE_LED_GAMMA_TABLES, tablesOk ? "full ok" : "WRONG");
+  ok &= tablesOk;
+  #endif
+  
+  if(!ok){
+    printf("\nA table DIFFERS or is WRONG\n");
+  }
+  return ok ? 0 : 1;
+}
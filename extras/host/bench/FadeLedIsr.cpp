@@ -0,0 +1,346 @@
+/**
+ *  @file FadeLedIsr.cpp
+ *  @brief Host stress test of the FADE_LED_ISR mode
+ *
+ *  @details A thread stands in for the timer interrupt and calls FadeLed::tick()
+ *  every 100us. Meanwhile the main thread hammers the objects with random begin(),
+ *  set(), setTime(), stop(), setRetarget() and FadeLedScene::fade() calls through the command
+ *  queue. After each tick every object is checked to be in a valid state: brightness in range and the
+ *  level written to its pin matches its current brightness. At the end every
+ *  command must be handled exactly once and all objects get a last brightness
+ *  they must reach, with that level written to their pin. A few objects write to
+ *  an output backend instead. Now and then the timer is held to check each of
+ *  its channels was sent or is still marked to send, at the end it must have
+ *  sent their last level.
+ *  A FadeLed object and a scene are made and destroyed with commands in the queue.
+ *  The main thread also calls FadeLed::update() and checks the list of
+ *  FadeLed::completed() holds each object at most once and nothing else.
+ *
+ *  Prints the number of commands, ticks and errors. Exits with 1 on an error.
+ *
+ *  Usage: fadeled_isr [--quick]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include "FadeLed.h"
+#include "FadeLedHal.h"
+
+namespace{
+  const unsigned int LedCount = 32;
+  const unsigned int OutputLeds = 8;
+  const unsigned long TimerPeriodUs = 100;
+
+  //Gives access to the state tick() works on
+  class CheckedLed : public FadeLed{
+    public:
+      CheckedLed() : FadeLed(0) {}
+      CheckedLed(byte pin) : FadeLed(pin) {}
+
+      //only call from the timer thread, between two ticks
+      bool valid(){
+        if(_curVal > biggestStep() || _setVal > biggestStep() || _startVal > biggestStep()){
+          return false;
+        }
+        long written = _output ? _output->read(_pin) : FadeLedHal::lastValue(_pin);
+        return written == -1 || written == getGamma(_curVal);
+      }
+      
+      //commands put in the queue and handled, only call with the timer stopped
+      byte queued(){
+        return _queued;
+      }
+      
+      byte applied(){
+        return _applied;
+      }
+      
+      #if FADE_LED_LOCK
+      //keeps the main thread from handling the queue or destroying an object meanwhile
+      static bool lock(){
+        return lockEngine();
+      }
+      
+      static void unlock(){
+        unlockEngine();
+      }
+      #endif
+  };
+
+  //Gives access to the commands of a scene
+  class CheckedScene : public FadeLedScene{
+    public:
+      CheckedScene(FadeLed* const* leds, const flvar_t* levels) : FadeLedScene(leds, levels, LedCount, false) {}
+
+      //fade()'s put in the queue and handled, only call with the timer stopped
+      byte queued(){
+        return _queued;
+      }
+
+      byte applied(){
+        return _applied;
+      }
+  };
+
+  //Keeps the levels each flush sent, to check no channel is left out
+  class CheckedOutput : public FadeLedOutput{
+    public:
+      CheckedOutput() : FadeLedOutput(_levels, OutputLeds), _sent() {}
+
+      flvar_t sent(byte channel){
+        return _sent[channel];
+      }
+
+      //every channel sent or marked to send, only call with the timer held
+      bool consistent(){
+        for(unsigned int i = 0; i < OutputLeds; i++){
+          bool marked = _dirtyRange != Clean && i >= (unsigned int)(_dirtyRange >> 8) && i <= (unsigned int)(_dirtyRange & 0xFF);
+          if(_sent[i] != _levels[i] && !marked){
+            return false;
+          }
+        }
+        return true;
+      }
+
+    protected:
+      flvar_t _levels[OutputLeds];
+      flvar_t _sent[OutputLeds];
+
+      void flush(byte first, byte last){
+        for(unsigned int i = first; i <= last && i < OutputLeds; i++){
+          _sent[i] = read(i);
+        }
+      }
+  };
+
+  CheckedLed* leds[LedCount + OutputLeds];
+  CheckedOutput output;
+  FadeLed* sceneLeds[LedCount];
+  flvar_t sceneLevels[LedCount];
+  CheckedScene scene(sceneLeds, sceneLevels);
+  std::atomic<unsigned long> invalid(0);
+  std::atomic<bool> hold(false);
+  std::atomic<bool> held(false);
+  //made and destroyed while tick() runs, its commands and place in the lists must go with it
+  FadeLed* temp = nullptr;
+  //same for a scene, made in place so a fade() handled after it's gone crashes on the filled memory
+  alignas(FadeLedScene) unsigned char tempSceneMem[sizeof(FadeLedScene)];
+
+  //Walks FadeLed::completed(), returns the number of objects or -1 if the list is wrong
+  int checkCompleted(){
+    bool seen[LedCount + OutputLeds] = {};
+    int count = 0;
+    for(FadeLed* led = FadeLed::completed(); led; led = led->nextCompleted()){
+      if(led == temp){
+        count++;
+        continue;
+      }
+      unsigned int i = 0;
+      while(i < LedCount + OutputLeds && leds[i] != led){
+        i++;
+      }
+      if(i == LedCount + OutputLeds || seen[i]){
+        return -1;
+      }
+      seen[i] = true;
+      count++;
+    }
+    return count;
+  }
+
+  void timerIsr(){
+    //the main thread looks at the output, like with the interrupt off
+    if(hold){
+      held = true;
+      return;
+    }
+    //let go, the main thread waits for this before it may hold again
+    if(held){
+      held = false;
+    }
+    
+    FadeLed::tick();
+    #if FADE_LED_LOCK
+    if(!CheckedLed::lock()){
+      return;
+    }
+    #endif
+    for(unsigned int i = 0; i < LedCount + OutputLeds; i++){
+      if(!leds[i]->valid()){
+        invalid++;
+      }
+    }
+    #if FADE_LED_LOCK
+    CheckedLed::unlock();
+    #endif
+  }
+}
+
+int main(int argc, char* argv[]){
+  double seconds = 2.0;
+  for(int i = 1; i < argc; i++){
+    if(!strcmp(argv[i], "--quick")){
+      seconds = 0.2;
+    }
+  }
+
+  printf("FadeLed FADE_LED_ISR stress: FADE_LED_PWM_BITS = %d, queue %d, %u leds, tick every %luus\n",
+         FADE_LED_PWM_BITS, FADE_LED_QUEUE_SIZE, LedCount, TimerPeriodUs);
+
+  //everything but the commands is set up before the timer starts
+  FadeLed::setInterval(1);
+  for(unsigned int i = 0; i < LedCount; i++){
+    leds[i] = new CheckedLed(i);
+    sceneLeds[i] = leds[i];
+    sceneLevels[i] = i * 7 % (leds[i]->getBiggestStep() + 1);
+  }
+  //not in the scene, channel 0 and up of the output
+  for(unsigned int i = 0; i < OutputLeds; i++){
+    leds[LedCount + i] = new CheckedLed(i);
+    leds[LedCount + i]->setOutput(&output);
+  }
+
+  FadeLedHal::startTimer(TimerPeriodUs, timerIsr);
+  //every pin and channel gets a known level, also the ones that end at 0
+  //after the timer starts, more commands than the queue holds
+  for(unsigned int i = 0; i < LedCount + OutputLeds; i++){
+    leds[i]->begin(0);
+  }
+
+  srand(1);
+  unsigned long commands = 0;
+  unsigned long completed = 0;
+  unsigned long badLists = 0;
+  unsigned long lostFlushes = 0;
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() +
+    std::chrono::microseconds((unsigned long)(seconds * 1e6));
+  while(std::chrono::steady_clock::now() < end){
+    FadeLed* led = leds[rand() % (LedCount + OutputLeds)];
+    switch(rand() % 8){
+      case 0:
+        led->begin(rand() % (led->getBiggestStep() + 1));
+        break;
+      case 1:
+        led->setTime(rand() % 200, rand() % 2);
+        break;
+      case 2:
+        led->stop();
+        break;
+      #if FADE_LED_RETARGET
+      case 3:
+        led->setRetarget(rand() % 3);
+        break;
+      #endif
+      case 4:
+        scene.fade(rand() % 200);
+        break;
+      default:
+        led->set(rand() % (led->getBiggestStep() + 1));
+        break;
+    }
+    commands++;
+    
+    if(rand() % 32 == 0){
+      delete temp;
+      temp = new FadeLed(LedCount);
+      temp->setTime(rand() % 50);
+      temp->set(rand() % (temp->getBiggestStep() + 1));
+      temp->set(rand() % (temp->getBiggestStep() + 1));
+    }
+    
+    if(rand() % 32 == 0){
+      FadeLedScene* tempScene = new(tempSceneMem) FadeLedScene(sceneLeds, sceneLevels, LedCount, false);
+      tempScene->fade(rand() % 50);
+      //mostly gone before tick() got to it
+      tempScene->~FadeLedScene();
+      memset(tempSceneMem, 0xFF, sizeof(tempSceneMem));
+    }
+    
+    if(rand() % 4 == 0){
+      FadeLed::update();
+      int count = checkCompleted();
+      if(count < 0){
+        badLists++;
+      }
+      else{
+        completed += count;
+      }
+    }
+
+    if(rand() % 256 == 0){
+      hold = true;
+      while(!held){
+      }
+      if(!output.consistent()){
+        lostFlushes++;
+      }
+      hold = false;
+      while(held){
+      }
+    }
+
+    //sometimes give tick() time to empty the queue
+    if(rand() % 64 == 0){
+      std::this_thread::sleep_for(std::chrono::microseconds(rand() % 300));
+    }
+  }
+
+  delete temp;
+  temp = nullptr;
+
+  //last brightness, constant speed so it's never ignored
+  for(unsigned int i = 0; i < LedCount + OutputLeds; i++){
+    leds[i]->setTime(20);
+    leds[i]->set(i * 3 % (leds[i]->getBiggestStep() + 1));
+  }
+
+  bool allDone = false;
+  end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while(!allDone && std::chrono::steady_clock::now() < end){
+    allDone = true;
+    for(unsigned int i = 0; i < LedCount + OutputLeds; i++){
+      allDone &= leds[i]->done();
+    }
+  }
+
+  FadeLedHal::stopTimer();
+  //send what's left
+  FadeLed::update();
+
+  unsigned long wrong = 0;
+  unsigned long lost = (scene.queued() != scene.applied()) ? 1 : 0;
+  for(unsigned int i = 0; i < LedCount; i++){
+    if(leds[i]->queued() != leds[i]->applied()){
+      lost++;
+    }
+    flvar_t target = i * 3 % (leds[i]->getBiggestStep() + 1);
+    if(leds[i]->getCurrent() != target || FadeLedHal::lastValue(i) != leds[i]->getGammaValue(target)){
+      wrong++;
+    }
+  }
+  for(unsigned int i = 0; i < OutputLeds; i++){
+    CheckedLed* led = leds[LedCount + i];
+    if(led->queued() != led->applied()){
+      lost++;
+    }
+    flvar_t target = (LedCount + i) * 3 % (led->getBiggestStep() + 1);
+    if(led->getCurrent() != target || output.sent(i) != led->getGammaValue(target)){
+      wrong++;
+    }
+  }
+
+  printf("%lu commands, %lu ticks, %lu invalid states, %lu lost commands, %lu wrong end states, %lu completed, %lu bad completed lists, %lu lost flushes%s\n",
+         commands, FadeLedHal::timerCalls(), (unsigned long)invalid, lost, wrong, completed, badLists, lostFlushes,
+         allDone ? "" : ", not all done");
+
+  for(unsigned int i = 0; i < LedCount + OutputLeds; i++){
+    delete leds[i];
+  }
+  return (invalid || lost || wrong || badLists || lostFlushes || !completed || !allDone) ? 1 : 0;
+}
@@ -0,0 +1,270 @@
+/**
+ *  @file FadeLedMulticore.cpp
+ *  @brief Host stress test of the FADE_LED_MULTICORE mode
+ *
+ *  @details One thread stands in for the core that runs loop(): it moves the
+ *  simulated clock an interval and calls FadeLed::update() over and over. A few
+ *  other threads stand in for tasks on the other core and hammer the objects
+ *  with random begin(), set(), setTime(), stop(), setRetarget() and FadeLedScene::fade()
+ *  calls, and read them back with get(), getCurrent(), done(), rising() and falling().
+ *  With a small queue the tasks often find it full and handle it themselves.
+ *
+ *  After each update the update thread checks every object is in a valid state:
+ *  brightness in range and the level written to its pin matches its current
+ *  brightness. The list of FadeLed::completed() must hold each object at most
+ *  once. The tasks check the brightness they read is in range. At the end each
+ *  task gives its objects a last brightness they must reach, every command must
+ *  be handled exactly once.
+ *
+ *  Built as fadeled_multicore_8 and _16, and with ThreadSanitizer as
+ *  fadeled_multicore_16_tsan (if the compiler has it) which also reports every
+ *  data race.
+ *
+ *  Prints the number of commands, updates and errors. Exits with 1 on an error.
+ *
+ *  Usage: fadeled_multicore [--quick]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "FadeLed.h"
+#include "FadeLedHal.h"
+
+namespace{
+  const unsigned int LedCount = 32;
+  const unsigned int TaskCount = 3;
+
+  //Gives access to the state update() works on
+  class CheckedLed : public FadeLed{
+    public:
+      CheckedLed(byte pin) : FadeLed(pin) {}
+
+      //only call with the objects locked
+      bool valid(){
+        if(_curVal > biggestStep() || _setVal > biggestStep() || _startVal > biggestStep()){
+          return false;
+        }
+        long written = FadeLedHal::lastValue(_pin);
+        return written == -1 || written == getGamma(_curVal);
+      }
+
+      //commands put in the queue and handled, only call when all threads stopped
+      byte queued(){
+        return _queued;
+      }
+
+      byte applied(){
+        return _applied;
+      }
+
+      //the objects for the checks, like update() takes them
+      static bool lock(){
+        return lockEngine();
+      }
+
+      static void unlock(){
+        unlockEngine();
+      }
+  };
+
+  //Gives access to the commands of a scene
+  class CheckedScene : public FadeLedScene{
+    public:
+      CheckedScene(FadeLed* const* leds, const flvar_t* levels) : FadeLedScene(leds, levels, LedCount, false) {}
+
+      //fade()'s put in the queue and handled, only call when all threads stopped
+      byte queued(){
+        return _queued;
+      }
+
+      byte applied(){
+        return _applied;
+      }
+  };
+
+  CheckedLed* leds[LedCount];
+  FadeLed* sceneLeds[LedCount];
+  flvar_t sceneLevels[LedCount];
+  CheckedScene scene(sceneLeds, sceneLevels);
+  std::atomic<bool> running(true);
+  std::atomic<bool> finishing(false);
+  std::atomic<unsigned int> stoppedTasks(0);
+  std::atomic<unsigned long> commands(0);
+  std::atomic<unsigned long> badReads(0);
+  unsigned long updates = 0;
+  unsigned long checks = 0;
+  unsigned long invalid = 0;
+  unsigned long completed = 0;
+  unsigned long badLists = 0;
+
+  //Walks FadeLed::completed(), returns the number of objects or -1 if the list is wrong
+  int checkCompleted(){
+    bool seen[LedCount] = {};
+    int count = 0;
+    for(FadeLed* led = FadeLed::completed(); led; led = led->nextCompleted()){
+      unsigned int i = 0;
+      while(i < LedCount && leds[i] != led){
+        i++;
+      }
+      if(i == LedCount || seen[i]){
+        return -1;
+      }
+      seen[i] = true;
+      count++;
+    }
+    return count;
+  }
+
+  //The core that runs loop()
+  void updateLoop(){
+    while(running){
+      FadeLedHal::advance(1);
+      FadeLed::update();
+      updates++;
+
+      int count = checkCompleted();
+      if(count < 0){
+        badLists++;
+      }
+      else{
+        completed += count;
+      }
+
+      //a task may be handling the queue, then check next time
+      if(CheckedLed::lock()){
+        for(unsigned int i = 0; i < LedCount; i++){
+          if(!leds[i]->valid()){
+            invalid++;
+          }
+        }
+        checks++;
+        CheckedLed::unlock();
+      }
+    }
+  }
+
+  flvar_t lastBrightness(unsigned int i){
+    return i * 3 % (leds[i]->getBiggestStep() + 1);
+  }
+
+  //A task on the other core, the last brightness for every TaskCount-th object
+  void task(unsigned int nr){
+    unsigned int seed = nr + 1;
+    while(!finishing){
+      FadeLed* led = leds[rand_r(&seed) % LedCount];
+      switch(rand_r(&seed) % 8){
+        case 0:
+          led->begin(rand_r(&seed) % (led->getBiggestStep() + 1));
+          break;
+        case 1:
+          led->setTime(rand_r(&seed) % 200, rand_r(&seed) % 2);
+          break;
+        case 2:
+          led->stop();
+          break;
+        #if FADE_LED_RETARGET
+        case 3:
+          led->setRetarget(rand_r(&seed) % 3);
+          break;
+        #endif
+        case 4:
+          scene.fade(rand_r(&seed) % 200);
+          break;
+        default:
+          led->set(rand_r(&seed) % (led->getBiggestStep() + 1));
+          break;
+      }
+      commands++;
+
+      led = leds[rand_r(&seed) % LedCount];
+      led->done();
+      led->rising();
+      led->falling();
+      if(led->get() > led->getBiggestStep() || led->getCurrent() > led->getBiggestStep()){
+        badReads++;
+      }
+    }
+
+    //no random command may come after a last brightness
+    stoppedTasks++;
+    while(stoppedTasks < TaskCount){
+    }
+    
+    //constant speed so it's never ignored
+    for(unsigned int i = nr; i < LedCount; i += TaskCount){
+      leds[i]->setTime(20);
+      leds[i]->set(lastBrightness(i));
+      commands += 2;
+    }
+  }
+}
+
+int main(int argc, char* argv[]){
+  double seconds = 2.0;
+  for(int i = 1; i < argc; i++){
+    if(!strcmp(argv[i], "--quick")){
+      seconds = 0.2;
+    }
+  }
+
+  printf("FadeLed FADE_LED_MULTICORE stress: FADE_LED_PWM_BITS = %d, queue %d, %u leds, %u tasks\n",
+         FADE_LED_PWM_BITS, FADE_LED_QUEUE_SIZE, LedCount, TaskCount);
+
+  //everything but the commands is set up before the tasks start
+  FadeLed::setInterval(1);
+  for(unsigned int i = 0; i < LedCount; i++){
+    leds[i] = new CheckedLed(i);
+    sceneLeds[i] = leds[i];
+    sceneLevels[i] = i * 7 % (leds[i]->getBiggestStep() + 1);
+  }
+
+  std::thread updater(updateLoop);
+  std::thread tasks[TaskCount];
+  for(unsigned int i = 0; i < TaskCount; i++){
+    tasks[i] = std::thread(task, i);
+  }
+
+  std::this_thread::sleep_for(std::chrono::microseconds((unsigned long)(seconds * 1e6)));
+  finishing = true;
+  for(unsigned int i = 0; i < TaskCount; i++){
+    tasks[i].join();
+  }
+
+  bool allDone = false;
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while(!allDone && std::chrono::steady_clock::now() < end){
+    allDone = true;
+    for(unsigned int i = 0; i < LedCount; i++){
+      allDone &= leds[i]->done();
+    }
+  }
+
+  running = false;
+  updater.join();
+
+  unsigned long wrong = 0;
+  unsigned long lost = (scene.queued() != scene.applied()) ? 1 : 0;
+  for(unsigned int i = 0; i < LedCount; i++){
+    if(leds[i]->queued() != leds[i]->applied()){
+      lost++;
+    }
+    flvar_t target = lastBrightness(i);
+    if(leds[i]->getCurrent() != target || FadeLedHal::lastValue(i) != leds[i]->getGammaValue(target)){
+      wrong++;
+    }
+  }
+
+  printf("%lu commands, %lu updates, %lu checks, %lu invalid states, %lu bad reads, %lu lost commands, %lu wrong end states, %lu completed, %lu bad completed lists%s\n",
+         (unsigned long)commands, updates, checks, invalid, (unsigned long)badReads, lost, wrong, completed, badLists,
+         allDone ? "" : ", not all done");
+
+  for(unsigned int i = 0; i < LedCount; i++){
+    delete leds[i];
+  }
+  return (invalid || badReads || lost || wrong || badLists || !completed || !checks || !allDone) ? 1 : 0;
+}
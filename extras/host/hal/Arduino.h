@@ -0,0 +1,44 @@
+/**
+ *  @file Arduino.h
+ *  @brief Minimal Arduino core stand-in to build FadeLed on a (Linux) host.
+ *
+ *  @details Only provides what FadeLed uses. The clock is a simulated clock that
+ *  only moves when told to and every analogWrite() is recorded. The digital pins
+ *  sit on simulated ports of 8 pins each (pin 0 to 7 on port 0 etc). See
+ *  FadeLedHal.h to control and inspect them. delay() waits real time, it doesn't
+ *  move the simulated clock.
+ */
+
+#ifndef _FADE_LED_HOST_ARDUINO_H
+#define _FADE_LED_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef ARDUINO
+#define ARDUINO 10800
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void analogWrite(uint8_t pin, int val);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+uint8_t digitalPinToPort(uint8_t pin);
+uint32_t digitalPinToBitMask(uint8_t pin);
+volatile uint32_t* FadeLedHalPortRegister(uint8_t port);
+//a macro in the real cores, code checks for it
+#define portOutputRegister(port) FadeLedHalPortRegister(port)
+
+#include "FadeLedHal.h"
+
+#endif
@@ -0,0 +1,141 @@
+#include "Arduino.h"
+#include "FadeLedHal.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace{
+  std::atomic<unsigned long> millisNow(0); //read by every thread of the FADE_LED_MULTICORE test
+  unsigned long writeCount = 0;
+  uint32_t hash = 0;
+  long pinValues[256];
+  bool pinValuesInit = false;
+  volatile uint32_t ports[32];
+  
+  std::thread timerThread;
+  std::atomic<bool> timerRunning(false);
+  std::atomic<unsigned long> timerCount(0);
+
+  //FNV-1a of a single write
+  uint32_t hashWrite(unsigned long time, uint8_t pin, int val){
+    uint32_t h = 2166136261UL;
+    uint8_t bytes[] = {(uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24),
+                       pin, (uint8_t)val, (uint8_t)(val >> 8)};
+    for(unsigned int i = 0; i < sizeof(bytes); i++){
+      h ^= bytes[i];
+      h *= 16777619UL;
+    }
+    return h;
+  }
+}
+
+unsigned long millis(){
+  return millisNow;
+}
+
+unsigned long micros(){
+  return millisNow * 1000UL;
+}
+
+void delay(unsigned long ms){
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void analogWrite(uint8_t pin, int val){
+  writeCount++;
+  hash += hashWrite(millisNow, pin, val);
+
+  if(!pinValuesInit){
+    for(int i = 0; i < 256; i++){
+      pinValues[i] = -1;
+    }
+    pinValuesInit = true;
+  }
+  pinValues[pin] = val;
+}
+
+void pinMode(uint8_t pin, uint8_t mode){
+  //every pin can be written
+}
+
+void digitalWrite(uint8_t pin, uint8_t val){
+  if(val){
+    ports[digitalPinToPort(pin)] |= digitalPinToBitMask(pin);
+  }
+  else{
+    ports[digitalPinToPort(pin)] &= ~digitalPinToBitMask(pin);
+  }
+}
+
+uint8_t digitalPinToPort(uint8_t pin){
+  return pin / 8;
+}
+
+uint32_t digitalPinToBitMask(uint8_t pin){
+  return 1UL << (pin % 8);
+}
+
+volatile uint32_t* FadeLedHalPortRegister(uint8_t port){
+  return &ports[port];
+}
+
+namespace FadeLedHal{
+  void setMillis(unsigned long ms){
+    millisNow = ms;
+  }
+
+  void advance(unsigned long ms){
+    millisNow += ms;
+  }
+
+  void resetWrites(){
+    writeCount = 0;
+    hash = 0;
+  }
+
+  unsigned long writes(){
+    return writeCount;
+  }
+
+  uint32_t writeHash(){
+    return hash;
+  }
+
+  long lastValue(uint8_t pin){
+    if(!pinValuesInit){
+      return -1;
+    }
+    return pinValues[pin];
+  }
+
+  void startTimer(unsigned long periodUs, void (*isr)()){
+    stopTimer();
+    timerCount = 0;
+    timerRunning = true;
+    timerThread = std::thread([periodUs, isr](){
+      std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+      while(timerRunning){
+        next += std::chrono::microseconds(periodUs);
+        std::this_thread::sleep_until(next);
+        isr();
+        timerCount++;
+      }
+    });
+  }
+
+  void stopTimer(){
+    timerRunning = false;
+    if(timerThread.joinable()){
+      timerThread.join();
+    }
+  }
+
+  unsigned long timerCalls(){
+    return timerCount;
+  }
+
+  bool digitalValue(uint8_t pin){
+    return ports[digitalPinToPort(pin)] & digitalPinToBitMask(pin);
+  }
+}
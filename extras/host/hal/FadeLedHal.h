@@ -0,0 +1,95 @@
+/**
+ *  @file FadeLedHal.h
+ *  @brief Control and inspection of the simulated Arduino core of the host build.
+ *
+ *  @details millis() only changes when the simulated clock is moved with setMillis()
+ *  or advance(). analogWrite() doesn't drive anything but counts the calls, keeps the
+ *  last value per pin and keeps a checksum over all (time, pin, value) writes. Two
+ *  builds of FadeLed that give the same output will end with the same checksum.
+ *
+ *  The 256 digital pins are on 32 ports of 8 pins, digitalWrite() and writes to
+ *  the port registers set them. digitalValue() reads them back.
+ *
+ *  startTimer() runs a thread that stands in for a hardware timer interrupt, to
+ *  test the FADE_LED_ISR mode. millis() may be read from any thread, the rest is
+ *  for one thread at a time.
+ */
+
+#ifndef _FADE_LED_HAL_H
+#define _FADE_LED_HAL_H
+
+#include <stdint.h>
+
+namespace FadeLedHal{
+  /**
+   *  @brief Sets the simulated clock
+   *
+   *  @param [in] ms New value returned by millis()
+   */
+  void setMillis(unsigned long ms);
+
+  /**
+   *  @brief Moves the simulated clock forward
+   *
+   *  @param [in] ms Number of ms to add to the clock
+   */
+  void advance(unsigned long ms);
+
+  /**
+   *  @brief Clears the analogWrite() counter and checksum
+   */
+  void resetWrites();
+
+  /**
+   *  @brief Number of analogWrite() calls since the last resetWrites()
+   */
+  unsigned long writes();
+
+  /**
+   *  @brief Checksum over all (time, pin, value) writes since resetWrites()
+   *
+   *  @details Sum of the FNV-1a hash of each write. So it doesn't depend on the order
+   *  of the writes within the same millis().
+   */
+  uint32_t writeHash();
+
+  /**
+   *  @brief Last value written to a pin with analogWrite()
+   *
+   *  @param [in] pin The pin to check
+   *  @return Last written value, -1 if never written
+   */
+  long lastValue(uint8_t pin);
+
+  /**
+   *  @brief Starts a thread that calls isr() every period, like a timer interrupt
+   *
+   *  @details Only one timer at a time. The thread doesn't interrupt the main
+   *  program like an interrupt would but runs next to it, which is a harder test
+   *  for the code sharing data with it.
+   *
+   *  @param [in] periodUs Time between two calls in us
+   *  @param [in] isr      Function to call
+   */
+  void startTimer(unsigned long periodUs, void (*isr)());
+
+  /**
+   *  @brief Stops the timer thread and waits for it to end
+   */
+  void stopTimer();
+
+  /**
+   *  @brief Number of isr() calls since startTimer()
+   */
+  unsigned long timerCalls();
+
+  /**
+   *  @brief Level of a digital pin
+   *
+   *  @param [in] pin The pin to check
+   *  @return true if HIGH
+   */
+  bool digitalValue(uint8_t pin);
+}
+
+#endif
@@ -0,0 +1,39 @@
+/**
+ *  @file FadeLedMockOutput.h
+ *  @brief Output backend for the host build that only counts.
+ *
+ *  @details Stands in for an I2C/SPI PWM driver. Each flush() counts as one bus
+ *  transaction and the channels in it are counted as well.
+ */
+
+#ifndef _FADE_LED_MOCK_OUTPUT_H
+#define _FADE_LED_MOCK_OUTPUT_H
+
+#include "FadeLed.h"
+
+class FadeLedMockOutput : public FadeLedOutput{
+  public:
+    /**
+     *  @param [in] channels Number of channels (max 256)
+     */
+    FadeLedMockOutput(unsigned int channels = 256) :
+      FadeLedOutput(_levels, channels),
+      transactions(0),
+      channelsSent(0)
+    {
+      
+    }
+
+    unsigned long transactions; //!< Number of flush() calls
+    unsigned long channelsSent; //!< Number of channels in all flush() calls
+
+  protected:
+    flvar_t _levels[256];
+
+    void flush(byte first, byte last){
+      transactions++;
+      channelsSent += last - first + 1;
+    }
+};
+
+#endif
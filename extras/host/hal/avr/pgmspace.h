@@ -0,0 +1,29 @@
+/**
+ *  @file pgmspace.h
+ *  @brief PROGMEM stand-in for the host build.
+ *
+ *  @details A host has one address space so PROGMEM is a normal const and the
+ *  pgm_read_*() macros are plain reads.
+ */
+
+#ifndef _FADE_LED_HOST_PGMSPACE_H
+#define _FADE_LED_HOST_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+
+#define pgm_read_byte_near(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word_near(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword_near(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr_near(addr)   (*(const void* const*)(addr))
+
+#define pgm_read_byte(addr)  pgm_read_byte_near(addr)
+#define pgm_read_word(addr)  pgm_read_word_near(addr)
+#define pgm_read_dword(addr) pgm_read_dword_near(addr)
+#define pgm_read_ptr(addr)   pgm_read_ptr_near(addr)
+
+#define memcpy_P(dest, src, n) memcpy((dest), (src), (n))
+
+#endif
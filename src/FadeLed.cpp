@@ -2,9 +2,40 @@
 #include "FadeLed.h"
 
 unsigned int FadeLed::_interval = 50;
-unsigned int FadeLed::_millisLast = 0;
-byte FadeLed::_ledCount = 0;
-FadeLed* FadeLed::_ledList[FADE_LED_MAX_LED];
+unsigned long FadeLed::_millisLast = 0;
+#if FADE_LED_TICKS
+unsigned long FadeLed::_tick = 0;
+#endif
+FadeLed* FadeLed::_ledFirst = nullptr;
+FadeLed* FadeLed::_ledLast = nullptr;
+#if FADE_LED_COMPACT
+FadeLed::GammaTable FadeLed::_gammaTables[FADE_LED_GAMMA_TABLES] = {
+  {FadeLedGammaTable, 100, 0},
+  {nullptr, FADE_LED_RESOLUTION, 0}
+};
+bool FadeLed::_gammaTablesFull = false;
+#endif
+FadeLed* FadeLed::_fadingList = nullptr;
+FadeLed* FadeLed::_completedList = nullptr;
+#if FADE_LED_ISR
+FadeLed* FadeLed::_finishedList = nullptr;
+#endif
+#if FADE_LED_STATS
+FadeLedStats FadeLed::_stats;
+#endif
+#if FADE_LED_SCHEDULER
+FadeLed* FadeLed::_wheel[FADE_LED_WHEEL_SIZE];
+unsigned long FadeLed::_wheelTick = 0;
+#endif
+#if FADE_LED_QUEUE
+FadeLed::Command FadeLed::_queue[FADE_LED_QUEUE_SIZE];
+byte FadeLed::_queueHead = 0;
+byte FadeLed::_queueTail = 0;
+#endif
+#if FADE_LED_LOCK
+bool FadeLed::_engineBusy = false;
+#endif
+void (*FadeLed::_hooks[FadeLed::NrHooks])() = {};
 
 FadeLed::FadeLed(byte pin) :
   FadeLed(pin, FadeLedGammaTable, 100)
@@ -14,55 +45,253 @@ FadeLed::FadeLed(byte pin) :
 
 FadeLed::FadeLed(byte pin, const flvar_t* gammaLookup, flvar_t biggestStep) :
   _pin(pin),
-  _count(0),
+  _setVal(0),
+  _startVal(0),
+  _curVal(0),
+  _constTime(false),
+  _fading(false),
+  #if FADE_LED_RETARGET
+  _retarget(RetargetIgnore),
+  #endif
   _countMax(40),
   //_countMax(2000 / _interval),
-  _constTime(false),
+  _count(0),
+  #if FADE_LED_TICKS
+  _startTick(0),
+  #endif
+  #if FADE_LED_COMPACT
+  _gamma(findGammaTable(gammaLookup, biggestStep, 0)),
+  #else
   _gammaLookup(gammaLookup),
-  _biggestStep(biggestStep)
+  _biggestStep(biggestStep),
+  _gammaSegmentBits(0),
+  #endif
+  #if FADE_LED_DITHER
+  _dither(false),
+  _ditherErr(0),
+  #endif
+  #if FADE_LED_EASING
+  _easing(FadeLedEaseLinear),
+  #endif
+  #if FADE_LED_RETARGET
+  _bend(0),
+  _countSet(40),
+  #endif
+  _output(nullptr),
+  #if FADE_LED_MASTER
+  _master(nullptr),
+  #endif
+  _nextFading(nullptr)
+  #if FADE_LED_SCHEDULER
+  ,
+  _prevFading(nullptr),
+  _dueTick(0)
+  #endif
+  ,
+  _nextCompleted(nullptr)
+  #if FADE_LED_ISR
+  ,
+  _nextFinished(nullptr)
+  #endif
+  #if FADE_LED_QUEUE
+  ,
+  _queued(0),
+  _applied(0)
+  #endif
+  #if FADE_LED_MULTICORE
+  ,
+  _shown(0)
+  #endif
 {  
-  //only add it if it fits
-  if(_ledCount < FADE_LED_MAX_LED){
-    _ledList[_ledCount++] = this;
+  #if FADE_LED_COMPACT
+  //list full (see gammaTablesFull()), use the default table
+  if(_gamma == FADE_LED_GAMMA_TABLES){
+    _gamma = 0;
   }
+  #endif
+  link();
 }
 
 FadeLed::FadeLed(byte pin, bool hasGammaTable) :
   FadeLed(pin, nullptr, FADE_LED_RESOLUTION)
 {  
   if(hasGammaTable){
+    #if FADE_LED_COMPACT
+    _gamma = 0;
+    #else
     _gammaLookup = FadeLedGammaTable;
     _biggestStep = 100;
+    #endif
   }
 }
 
+FadeLed::FadeLed(const FadeLed& other) :
+  FadeLed(other._pin, other.gammaLookup(), other.biggestStep())
+{
+  _setVal = other._curVal;
+  _startVal = other._curVal;
+  _curVal = other._curVal;
+  _constTime = other._constTime;
+  _countMax = other._countMax;
+  #if FADE_LED_COMPACT
+  _gamma = other._gamma;
+  #else
+  _gammaSegmentBits = other._gammaSegmentBits;
+  #endif
+  #if FADE_LED_DITHER
+  _dither = other._dither;
+  #endif
+  #if FADE_LED_EASING
+  _easing = other._easing;
+  #endif
+  #if FADE_LED_RETARGET
+  _retarget = other._retarget;
+  _countSet = other._countSet;
+  _countMax = other._countSet;
+  #endif
+  _output = other._output;
+  #if FADE_LED_MASTER
+  _master = other._master;
+  #endif
+  publish();
+}
+
 FadeLed::~FadeLed(){
-  //Find current possition of this object
-  byte posThis=0;
-  while((posThis < _ledCount) && (_ledList[posThis] != this)){
-    posThis++;
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may not see it halfway
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #elif FADE_LED_LOCK
+  //wait for a tick() or update() on another core, tick() skips an interval meanwhile
+  while(!lockEngine()){
+    delay(1);
+  }
+  #endif
+  {
+    unlink();
+  }
+  #if FADE_LED_LOCK
+  unlockEngine();
+  #endif
+}
+
+void FadeLed::unlink(){
+  //Remove from the fading objects
+  #if FADE_LED_SCHEDULER
+  if(_fading){
+    unschedule();
+  }
+  #else
+  if(_fading){
+    FadeLed** link = &_fadingList;
+    while(*link != this){
+      link = &(*link)->_nextFading;
+    }
+    *link = _nextFading;
   }
+  #endif
   
-  //if not in the list (how weird), it's done
-  if(posThis == _ledCount){
-    return;
+  //Remove from completed()
+  FadeLed** completed = &_completedList;
+  while(*completed && *completed != this){
+    completed = &(*completed)->_nextCompleted;
+  }
+  if(*completed){
+    *completed = _nextCompleted;
   }
   
-  //Otherwise, delete this object by shifting in the rest
-  _ledCount--;
-  for(byte i = posThis; i < _ledCount; i++){
-    _ledList[i] = _ledList[i + 1];
+  #if FADE_LED_ISR
+  //Remove from the objects tick() finished, the last points to itself
+  if(_nextFinished){
+    FadeLed* prev = nullptr;
+    for(FadeLed* led = _finishedList; led != this; led = led->_nextFinished){
+      prev = led;
+    }
+    bool last = (_nextFinished == this);
+    if(prev){
+      prev->_nextFinished = last ? prev : _nextFinished;
+    }
+    else{
+      _finishedList = last ? nullptr : _nextFinished;
+    }
   }
+  #endif
+  
+  #if FADE_LED_QUEUE
+  //Drop the commands for it that tick() didn't handle yet
+  dropCommands(this);
+  #endif
+  
+  //Unlink from all objects
+  #if FADE_LED_COMPACT
+  //only linked forward, find the one before
+  FadeLed* prevLed = nullptr;
+  FadeLed** link = &_ledFirst;
+  while(*link != this){
+    prevLed = *link;
+    link = &(*link)->_nextLed;
+  }
+  *link = _nextLed;
+  
+  if(!_nextLed){
+    _ledLast = prevLed;
+  }
+  #else
+  if(_prevLed){
+    _prevLed->_nextLed = _nextLed;
+  }
+  else{
+    _ledFirst = _nextLed;
+  }
+  
+  if(_nextLed){
+    _nextLed->_prevLed = _prevLed;
+  }
+  else{
+    _ledLast = _prevLed;
+  }
+  #endif
+}
+
+void FadeLed::link(){
+  #if !FADE_LED_COMPACT
+  _prevLed = _ledLast;
+  #endif
+  _nextLed = nullptr;
+  
+  if(_ledLast){
+    _ledLast->_nextLed = this;
+  }
+  else{
+    _ledFirst = this;
+  }
+  _ledLast = this;
 }
 
 void FadeLed::begin(flvar_t val){
+  #if FADE_LED_QUEUE
+  push(CommandBegin, val);
+  #else
+  beginNow(val);
+  #endif
+}
+
+void FadeLed::beginNow(flvar_t val){
   //set to both so no fading happens
   _setVal = val;
   _curVal = val;
-  analogWrite(this->_pin, getGamma(_curVal));
+  write(outputLevel(_curVal));
+  publish();
 }
 
 void FadeLed::set(flvar_t val){
+  #if FADE_LED_QUEUE
+  push(CommandSet, val);
+  #else
+  setNow(val);
+  #endif
+}
+
+void FadeLed::setNow(flvar_t val){
   
   /** edit 2016-11-17
    *  Fix so you can set it to a new value while 
@@ -74,15 +303,18 @@ void FadeLed::set(flvar_t val){
      *  Fixed out of range possibility
      */
     //check for out of range
-    if(val > _biggestStep){
+    if(val > biggestStep()){
       //if bigger then allowed, use biggest value
-      val = _biggestStep;
+      val = biggestStep();
     }    
     
     //if it's now fading we have to check how to change it
-    if(!done()){
-      //setting new val while fading in constant time not possible
+    if(!doneNow()){
+      //setting new val while fading in constant time not possible, unless retargeting
       if(_constTime){
+        #if FADE_LED_RETARGET
+        if(_retarget == RetargetIgnore)
+        #endif
         return;
       }
       //if in constant speed the new val is in same direction and not passed yet
@@ -90,18 +322,50 @@ void FadeLed::set(flvar_t val){
               ( (_startVal > _setVal) && (_curVal > val)) ){ //down
         //just set a new val
         _setVal = val;
+        publish();
+        #if FADE_LED_TRACE
+        traceFade(false);
+        #endif
         return;
       }
     }
     
     //if we make it here it's or finished fading
     //or constant speed in other direction
+    //or a retarget
+    #if FADE_LED_RETARGET
+    if(_constTime && !doneNow()){
+      retarget(val);
+    }
+    else{
+      _countMax = _countSet;
+      _bend = 0;
+    }
+    #endif
+    
     //save and reset
     _setVal = val;
     _count = 1;
+    #if FADE_LED_TICKS
+    _startTick = currentTick();
+    #endif
     
     //and start fading from current position
     _startVal = _curVal;
+    
+    #if FADE_LED_INCREMENTAL
+    setupStep();
+    #endif
+    
+    publish();
+    
+    //let update() know
+    if(!doneNow()){
+      startFading();
+      #if FADE_LED_TRACE
+      traceFade(true);
+      #endif
+    }
   }
   
   
@@ -117,19 +381,54 @@ void FadeLed::set(flvar_t val){
 }
 
 flvar_t FadeLed::get(){
+  #if FADE_LED_MULTICORE
+  return __atomic_load_n(&_shown, __ATOMIC_ACQUIRE) >> 16;
+  #elif FADE_LED_ISR && defined(__AVR__) && FADE_LED_PWM_BITS > 8
+  //tick() may not change it halfway reading
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+    return _setVal;
+  }
+  #endif
   return _setVal;
 }
 
 flvar_t FadeLed::getCurrent(){
+  #if FADE_LED_MULTICORE
+  return (flvar_t)__atomic_load_n(&_shown, __ATOMIC_ACQUIRE);
+  #elif FADE_LED_ISR && defined(__AVR__) && FADE_LED_PWM_BITS > 8
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+    return _curVal;
+  }
+  #endif
   return _curVal;
 }
 
 bool FadeLed::done(){
+  #if FADE_LED_MULTICORE
+  //a command tick() didn't handle yet, other tasks may add one
+  if(__atomic_load_n(&_queued, __ATOMIC_RELAXED) != __atomic_load_n(&_applied, __ATOMIC_ACQUIRE)){
+    return false;
+  }
+  //both from the same change
+  uint32_t shown = __atomic_load_n(&_shown, __ATOMIC_ACQUIRE);
+  return (flvar_t)shown == (flvar_t)(shown >> 16);
+  #else
+  #if FADE_LED_QUEUE
+  //a command tick() didn't handle yet
+  if(_queued != __atomic_load_n(&_applied, __ATOMIC_ACQUIRE)){
+    return false;
+  }
+  #endif
+  return getCurrent() == get();
+  #endif
+}
+
+bool FadeLed::doneNow(){
   return _curVal == _setVal;
 }
 
 void FadeLed::on(){
-  this->set(_biggestStep);
+  this->set(biggestStep());
 }
 
 void FadeLed::off(){
@@ -137,39 +436,342 @@ void FadeLed::off(){
 }
 
 void FadeLed::beginOn(){
-  this->begin(_biggestStep);
+  this->begin(biggestStep());
 }
 
 void FadeLed::setTime(unsigned long time, bool constTime){
+  #if FADE_LED_QUEUE
+  push(CommandSetTime, time, constTime);
+  #else
+  setTimeNow(time, constTime);
+  #endif
+}
+
+void FadeLed::setTimeNow(unsigned long time, bool constTime){
   //Calculate how many times interval need to pass in a fade
-  this->_countMax = time / _interval;
+  unsigned long count = time / _interval;
+  #if FADE_LED_MAX_INTERVALS < 4294967294UL
+  if(count > FADE_LED_MAX_INTERVALS){
+    count = FADE_LED_MAX_INTERVALS;
+  }
+  #endif
+  this->_countMax = count;
   this->_constTime = constTime;
+  #if FADE_LED_RETARGET
+  this->_countSet = this->_countMax;
+  #endif
+  
+  #if FADE_LED_INCREMENTAL
+  //continue the current fade with the new time
+  if(!doneNow()){
+    setupStep();
+  }
+  #endif
+  
+  #if FADE_LED_SCHEDULER
+  //the next change moved
+  if(_fading){
+    startFading();
+  }
+  #endif
+}
+
+bool FadeLed::curved(){
+  #if FADE_LED_RETARGET
+  if(_bend){
+    return true;
+  }
+  #endif
+  #if FADE_LED_EASING
+  return _easing != FadeLedEaseLinear;
+  #else
+  return false;
+  #endif
+}
+
+#if FADE_LED_EASING
+void FadeLed::setEasing(const uint16_t* easing){
+  #if FADE_LED_QUEUE
+  push(CommandSetEasing, (unsigned long)easing);
+  #else
+  setEasingNow(easing);
+  #endif
+}
+
+void FadeLed::setEasingNow(const uint16_t* easing){
+  _easing = easing;
+  
+  #if FADE_LED_INCREMENTAL
+  //the engine counts progress instead of steps with a curve
+  if(!doneNow()){
+    setupStep();
+  }
+  #endif
+  
+  #if FADE_LED_SCHEDULER
+  if(_fading){
+    startFading();
+  }
+  #endif
+}
+
+long FadeLed::curvePos(){
+  //progress, FADE_LED_RESOLUTION is done
+  #if FADE_LED_INCREMENTAL
+  unsigned long progress = _step.pos;
+  #else
+  unsigned long progress = FADE_LED_RESOLUTION;
+  if(_count < _countMax){
+    progress = (unsigned long)_count * FADE_LED_RESOLUTION / _countMax;
+  }
+  #endif
+  if(progress > FADE_LED_RESOLUTION){
+    progress = FADE_LED_RESOLUTION;
+  }
+  
+  //to 1/32768, the top half moves up one so FADE_LED_RESOLUTION becomes 32768
+  progress += progress >> (FADE_LED_PWM_BITS - 1);
+  #if FADE_LED_PWM_BITS <= 15
+  progress <<= 15 - FADE_LED_PWM_BITS;
+  #else
+  progress >>= FADE_LED_PWM_BITS - 15;
+  #endif
+  
+  flvar_t dist = biggestStep();
+  if(_constTime){
+    dist = (_setVal > _startVal) ? (_setVal - _startVal) : (_startVal - _setVal);
+  }
+  unsigned long eased = _easing ? FadeLedEasingRead(_easing, progress) : progress;
+  long pos = (eased * dist) >> 7;
+  
+  #if FADE_LED_RETARGET
+  //Hermite bend p(1-p)^2, starts with a slope of 1 and ends flat
+  if(_bend){
+    unsigned long rest = 32768 - progress;
+    unsigned long bend = ((progress * rest) >> 15) * rest >> 15;
+    pos += (_bend * (long)bend) >> 7;
+  }
+  #endif
+  return pos;
+}
+
+flvar_t FadeLed::curveVal(bool up){
+  long pos = curvePos() >> 8;
+  long val = up ? (long)_startVal + pos : (long)_startVal - pos;
+  
+  //a retargeted fade may first move on past the start
+  if(val < 0){
+    return 0;
+  }
+  if(val > (long)biggestStep()){
+    return biggestStep();
+  }
+  return val;
+}
+#endif
+
+#if FADE_LED_RETARGET
+void FadeLed::setRetarget(byte mode){
+  #if FADE_LED_QUEUE
+  push(CommandSetRetarget, mode);
+  #else
+  setRetargetNow(mode);
+  #endif
+}
+
+void FadeLed::setRetargetNow(byte mode){
+  _retarget = mode;
 }
 
+void FadeLed::retarget(flvar_t val){
+  //ticks of the new fade
+  unsigned long ticks = _countSet;
+  if(_retarget == RetargetRemaining && _count <= _countMax){
+    ticks = _countMax - _count + 1;
+  }
+  
+  //progress (1/1024) of the running fade at the brightness now
+  long speed = 0;
+  if(_countMax){
+    unsigned long count = _count ? _count - 1 : 0;
+    if(count > _countMax){
+      count = _countMax;
+    }
+    long progress = count * 1024 / _countMax;
+    
+    //steps per whole fade it moves with now, the slope of the curve and of the bend
+    long dist = (_setVal > _startVal) ? (_setVal - _startVal) : (_startVal - _setVal);
+    long slope = _easing ? FadeLedEasingSlope(_easing, progress << 5) : 1024;
+    speed = dist * (slope >> 2) >> 8;
+    speed += _bend * ((1024 - progress) * (1024 - 3 * progress) / 1024) / 1024;
+    
+    //to 1/256 steps per tick, up is positive
+    speed = speed * 256 / (long)_countMax;
+    if(_setVal < _startVal){
+      speed = -speed;
+    }
+  }
+  
+  //same speed over the new fade, in its direction
+  long dist = (val > _curVal) ? (val - _curVal) : (_curVal - val);
+  if(val < _curVal){
+    speed = -speed;
+  }
+  long most = 4L * biggestStep();
+  long slope;
+  if(ticks && speed > most * 256 / (long)ticks){
+    slope = most;
+  }
+  else if(ticks && -speed > most * 256 / (long)ticks){
+    slope = -most;
+  }
+  else{
+    slope = speed * (long)ticks / 256;
+  }
+  
+  //the bend makes up the difference with the start of the fade itself
+  long start = _easing ? FadeLedEasingSlope(_easing, 0) : 1024;
+  long bend = slope - (dist * (start >> 2) >> 8);
+  
+  //more than 3 times the distance overshoots, less than -3 times the full range only moves on further
+  if(bend > 3 * dist){
+    bend = 3 * dist;
+  }
+  else if(bend < -3L * biggestStep()){
+    bend = -3L * biggestStep();
+  }
+  
+  _countMax = ticks;
+  _bend = bend;
+}
+#endif
+
+#if FADE_LED_DITHER
+void FadeLed::setDither(bool dither){
+  _dither = dither;
+}
+#endif
+
 bool FadeLed::rising(){
-  return (_curVal < _setVal);
+  #if FADE_LED_MULTICORE
+  uint32_t shown = __atomic_load_n(&_shown, __ATOMIC_ACQUIRE);
+  return (flvar_t)shown < (flvar_t)(shown >> 16);
+  #else
+  return (getCurrent() < get());
+  #endif
 }
 
 bool FadeLed::falling(){
-  return (_curVal > _setVal);
+  #if FADE_LED_MULTICORE
+  uint32_t shown = __atomic_load_n(&_shown, __ATOMIC_ACQUIRE);
+  return (flvar_t)shown > (flvar_t)(shown >> 16);
+  #else
+  return (getCurrent() > get());
+  #endif
 }
 
 void FadeLed::stop(){
+  #if FADE_LED_QUEUE
+  push(CommandStop, 0);
+  #else
+  stopNow();
+  #endif
+}
+
+void FadeLed::stopNow(){
   _setVal = _curVal;
+  publish();
 }
 
-void FadeLed::setGammaTable(const flvar_t* table, flvar_t biggestStep){
+void FadeLed::startScene(flvar_t val, flcount_t countMax, unsigned long startTick){
+  if(val > biggestStep()){
+    val = biggestStep();
+  }
+  
+  //constant time, no checks of the fade it's in
+  _constTime = true;
+  _countMax = countMax;
+  #if FADE_LED_RETARGET
+  _countSet = countMax;
+  _bend = 0;
+  #endif
+  
+  _setVal = val;
+  _count = 1;
+  #if FADE_LED_TICKS
+  _startTick = startTick;
+  #endif
+  _startVal = _curVal;
+  
+  #if FADE_LED_INCREMENTAL
+  setupStep();
+  #endif
+  
+  publish();
+  
+  if(!doneNow()){
+    startFading();
+    #if FADE_LED_TRACE
+    traceFade(true);
+    #endif
+  }
+}
+
+bool FadeLed::setGammaTable(const flvar_t* table, flvar_t biggestStep, byte segmentBits){
   //stops the current fading for no funny things
-  stop();
+  stopNow();
   
   //Next time fade from 0
   _setVal = 0;
   _curVal = 0;
   _count = 1;
+  publish();
   
   //Sets up the new gamma table
+  #if FADE_LED_COMPACT
+  byte gamma = findGammaTable(table, biggestStep, segmentBits);
+  if(gamma == FADE_LED_GAMMA_TABLES){
+    return false;
+  }
+  _gamma = gamma;
+  #else
   _gammaLookup = table;
   _biggestStep = biggestStep;
+  _gammaSegmentBits = segmentBits;
+  #endif
+  return true;
+}
+
+#if FADE_LED_COMPACT
+byte FadeLed::findGammaTable(const flvar_t* table, flvar_t biggestStep, byte segmentBits){
+  for(byte i = 0; i < FADE_LED_GAMMA_TABLES; i++){
+    GammaTable& entry = _gammaTables[i];
+    if(entry.lookup == table && entry.biggestStep == biggestStep && entry.segmentBits == segmentBits){
+      return i;
+    }
+    //first unused place
+    if(!entry.biggestStep){
+      entry.lookup = table;
+      entry.biggestStep = biggestStep;
+      entry.segmentBits = segmentBits;
+      return i;
+    }
+  }
+  _gammaTablesFull = true;
+  return FADE_LED_GAMMA_TABLES;
+}
+#endif
+
+bool FadeLed::gammaTablesFull(){
+  #if FADE_LED_COMPACT
+  return _gammaTablesFull;
+  #else
+  return false;
+  #endif
+}
+
+void FadeLed::setOutput(FadeLedOutput* output){
+  _output = output;
 }
 
 void FadeLed::noGammaTable(){
@@ -177,96 +779,396 @@ void FadeLed::noGammaTable(){
 }
 
 flvar_t FadeLed::getGammaValue(flvar_t step){
-  if(step > _biggestStep){
-    step = _biggestStep;
+  if(step > biggestStep()){
+    step = biggestStep();
   }
   return FadeLed::getGamma(step);
 }
 
 flvar_t FadeLed::getBiggestStep(){
-  return _biggestStep;
+  return biggestStep();
 }
 
 void FadeLed::updateThis(){
-  //need to fade up
-  if(_curVal < _setVal){
-    flvar_t newVal;
-    
-    //we always start at the current level saved in _startVal
-    if(_constTime){
-      //for constant fade time we add the difference over countMax steps
-      newVal = _startVal + _count * (_setVal - _startVal) / _countMax;
+  #if FADE_LED_STATS
+  _stats.ledsUpdated++;
+  #endif
+  
+  #if FADE_LED_TICKS
+  catchUp();
+  #endif
+  
+  if(_curVal == _setVal){
+    return;
+  }
+  flvar_t newVal;
+  
+  //we always start at the current level saved in _startVal
+  #if FADE_LED_EASING
+  if(curved()){
+    bool up = (_curVal < _setVal);
+    newVal = curveVal(up);
+    //Check for overshoot, a curve can't overflow
+    if(up ? (newVal > _setVal) : (newVal < _setVal)){
+      newVal = _setVal;
     }
-    else{
-      //for constant fade speed we add the full resolution over countMax steps
-      newVal = _startVal + _count * _biggestStep / _countMax;
+  }
+  else
+  #endif
+  {
+    #if FADE_LED_INCREMENTAL
+    newVal = FadeLedStepTo(_startVal, _setVal, _step.pos);
+    #else
+    //for constant fade time the difference over countMax steps, for constant fade speed the full resolution
+    flvar_t dist = biggestStep();
+    if(_constTime){
+      dist = (_setVal > _startVal) ? (_setVal - _startVal) : (_startVal - _setVal);
     }
+    flcount_t rem;
+    newVal = FadeLedStepTo(_startVal, _setVal, FadeLedStepPos(_count, dist, _countMax, rem));
+    #endif
+  }
+  
+  //check if new
+  if(newVal != _curVal){
+    _curVal = newVal;
     
-    //check if new
-    if(newVal != _curVal){
-      //check for overflow
-      if(newVal < _curVal){
-        _curVal = _biggestStep;
-      }
-      //Check for overshoot
-      else if(newVal > _setVal){
-        _curVal = _setVal;
+    #if FADE_LED_DITHER
+    if(!_dither)
+    #endif
+    #if FADE_LED_MASTER
+    //otherwise written by redimAll()
+    if(!masterChanged())
+    #endif
+    write(outputLevel(_curVal));
+    publish();
+  }
+  #if FADE_LED_STATS
+  #if FADE_LED_DITHER
+  else if(!_dither)
+  #else
+  else
+  #endif
+  {
+    _stats.writesSkipped++;
+  }
+  #endif
+  #if FADE_LED_DITHER
+  //a fade never passes _setVal, so still the same direction
+  if(_dither){
+    writeDither(_curVal < _setVal);
+  }
+  #endif
+  _count++;
+  #if FADE_LED_INCREMENTAL
+  _step.next(_countMax);
+  #endif
+}
+
+void FadeLed::startFading(){
+  #if FADE_LED_SCHEDULER
+  //the fade changed, the next change may be sooner
+  if(_fading){
+    unschedule();
+  }
+  _fading = true;
+  schedule(_tick + 1);
+  #else
+  if(!_fading){
+    _fading = true;
+    _nextFading = _fadingList;
+    _fadingList = this;
+  }
+  #endif
+}
+
+void FadeLed::finished(){
+  #if FADE_LED_ISR && defined(__AVR__)
+  //update() can't run during the interrupt
+  if(!_nextFinished){
+    _nextFinished = _finishedList ? _finishedList : this;
+    _finishedList = this;
+  }
+  #elif FADE_LED_ISR
+  //already waiting for update()
+  if(__atomic_load_n(&_nextFinished, __ATOMIC_ACQUIRE)){
+    return;
+  }
+  
+  FadeLed* head = __atomic_load_n(&_finishedList, __ATOMIC_ACQUIRE);
+  do{
+    _nextFinished = head ? head : this;
+  } while(!__atomic_compare_exchange_n(&_finishedList, &head, this, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+  #else
+  _nextCompleted = _completedList;
+  _completedList = this;
+  #endif
+}
+
+#if FADE_LED_SCHEDULER
+void FadeLed::schedule(unsigned long due){
+  FadeLed** slot = &_wheel[due & (FADE_LED_WHEEL_SIZE - 1)];
+  
+  _dueTick = due;
+  _prevFading = nullptr;
+  _nextFading = *slot;
+  if(*slot){
+    (*slot)->_prevFading = this;
+  }
+  *slot = this;
+}
+
+void FadeLed::unschedule(){
+  if(_prevFading){
+    _prevFading->_nextFading = _nextFading;
+  }
+  else{
+    _wheel[_dueTick & (FADE_LED_WHEEL_SIZE - 1)] = _nextFading;
+  }
+  if(_nextFading){
+    _nextFading->_prevFading = _prevFading;
+  }
+}
+
+unsigned long FadeLed::nextChange(){
+  #if FADE_LED_DITHER
+  if(_dither){
+    return _tick + 1;
+  }
+  #endif
+  
+  #if FADE_LED_INCREMENTAL
+  //steps faded at the count written last
+  flvar_t pos = (_curVal > _startVal) ? (_curVal - _startVal) : (_startVal - _curVal);
+  
+  //a step (or more) every tick or the next tick already moves a step (the remainder just wrapped)
+  if(_step.div || !_step.mod || _step.err < _step.mod){
+    return _tick + 1;
+  }
+  #if FADE_LED_EASING
+  //with a curve the engine counts progress, the output can only change when that moves
+  if(!curved())
+  #endif
+  if(_step.pos != pos){
+    return _tick + 1;
+  }
+  
+  //ticks after the next one until the remainder reaches a step, jump the engine there
+  unsigned long wait = ((unsigned long)_countMax - _step.err + _step.mod - 1) / _step.mod;
+  _count += wait;
+  _step.err += wait * _step.mod - _countMax;
+  _step.pos++;
+  return _tick + 1 + wait;
+  #else
+  #if FADE_LED_EASING
+  if(curved()){
+    return _tick + 1;
+  }
+  #endif
+  
+  unsigned long dist = biggestStep();
+  if(_constTime){
+    dist = (_setVal > _startVal) ? (_setVal - _startVal) : (_startVal - _setVal);
+  }
+  
+  //a step (or more) every tick
+  if(dist >= _countMax){
+    return _tick + 1;
+  }
+  
+  //steps faded at the count written last and the first count a step further
+  unsigned long count = _count - 1;
+  unsigned long pos = count * dist / _countMax;
+  unsigned long next = ((pos + 1) * _countMax + dist - 1) / dist;
+  return _tick + (next - count);
+  #endif
+}
+
+void FadeLed::tickWheel(){
+  //normally one slot, more if update() counted more ticks
+  unsigned long passed = _tick - _wheelTick;
+  if(passed > FADE_LED_WHEEL_SIZE){
+    passed = FADE_LED_WHEEL_SIZE;
+  }
+  
+  for(unsigned long i = 1; i <= passed; i++){
+    FadeLed** slot = &_wheel[(_wheelTick + i) & (FADE_LED_WHEEL_SIZE - 1)];
+    FadeLed* led = *slot;
+    *slot = nullptr;
+    
+    while(led){
+      FadeLed* next = led->_nextFading;
+      
+      //due on a later round of the wheel
+      if((long)(_tick - led->_dueTick) < 0){
+        led->schedule(led->_dueTick);
       }
-      //Only if the new value is good we use that
       else{
-        _curVal = newVal;
+        led->updateThis();
+        
+        if(led->doneNow()){
+          led->_fading = false;
+          led->finished();
+        }
+        else{
+          led->schedule(led->nextChange());
+        }
       }
-          
-      analogWrite(this->_pin, getGamma(_curVal) );
+      led = next;
     }
-    _count++;
   }
-  //need to fade down
-  else if(_curVal > _setVal){
-    flvar_t newVal;
-    
-    //we always start at the current level saved in _startVal
-    if(_constTime){
-      //for constant fade time we subtract the difference over countMax steps
-      newVal = _startVal - _count * (_startVal - _setVal) / _countMax;
-    }
-    else{
-      //for constant fade speed we subtract the full resolution over countMax steps
-      newVal = _startVal - _count * _biggestStep / _countMax;
+  _wheelTick = _tick;
+}
+#endif
+
+#if FADE_LED_DITHER
+void FadeLed::writeDither(bool up){
+  //fraction (1/256) of a step past _curVal in fading direction
+  unsigned int frac = 0;
+  if(_curVal != _setVal){
+    #if FADE_LED_EASING
+    if(curved()){
+      //no fraction while a retargeted fade moves on past the start
+      long pos = curvePos();
+      frac = (pos < 0) ? 0 : (pos & 0xFF);
     }
-    
-    //check if new
-    if(newVal != _curVal){
-      //check for overflow
-      if(newVal > _curVal){
-        _curVal = 0;
-      }
-      //Check for overshoot
-      else if(newVal < _setVal){
-        _curVal = _setVal;
-      }
-      //Only if the new value is good we use that
-      else{
-        _curVal = newVal;
+    else
+    #endif
+    #if FADE_LED_INCREMENTAL
+    frac = (_step.err * _ditherScale) >> 16;
+    #else
+    {
+      flvar_t dist = biggestStep();
+      if(_constTime){
+        dist = up ? (_setVal - _startVal) : (_startVal - _setVal);
       }
-          
-      analogWrite(this->_pin, getGamma(_curVal) );
+      frac = ((((unsigned long)_count * dist) % _countMax) << 8) / _countMax;
     }
-    _count++;
+    #endif
+  }
+  
+  //find the two steps to interpolate between
+  flvar_t low = _curVal;
+  if(!up && frac){
+    low--;
+    frac = 256 - frac;
+  }
+  
+  #if FADE_LED_MASTER
+  //scale the position between the steps, before the gamma correction
+  if(_master && _master->_scale != FadeLedMaster::One){
+    unsigned long pos = (((unsigned long)low << 8) + frac) * (_master->_scale >> 8) >> 8;
+    low = pos >> 8;
+    frac = pos & 0xFF;
+  }
+  #endif
+  
+  //output level in 1/256
+  unsigned long out = (unsigned long)getGamma(low) << 8;
+  if(frac){
+    out += (long)frac * ((long)getGamma(low + 1) - (long)getGamma(low));
+  }
+  
+  //dither the part that doesn't fit the output
+  unsigned int err = _ditherErr + (out & 0xFF);
+  out >>= 8;
+  if(err > 0xFF){
+    out++;
+  }
+  _ditherErr = err;
+  
+  write(out);
+}
+#endif
+
+#if FADE_LED_INCREMENTAL
+void FadeLed::setupStep(){
+  //same distance the division would use
+  flvar_t dist = biggestStep();
+  if(_constTime){
+    dist = (_setVal > _startVal) ? (_setVal - _startVal) : (_startVal - _setVal);
+  }
+  #if FADE_LED_EASING
+  //count the progress for the curve instead
+  if(curved()){
+    dist = FADE_LED_RESOLUTION;
+  }
+  #endif
+  
+  #if FADE_LED_DITHER
+  _ditherScale = _countMax ? (1UL << 24) / _countMax : 0;
+  #endif
+  
+  _step.setup(_count, dist, _countMax);
+}
+#endif
+
+#if FADE_LED_TICKS
+unsigned long FadeLed::currentTick(){
+  #if FADE_LED_ELAPSED_TIME
+  return _tick + (millis() - _millisLast) / _interval;
+  #else
+  return _tick;
+  #endif
+}
+
+void FadeLed::catchUp(){
+  unsigned long count = _tick - _startTick;
+  if(count > _countMax){
+    count = _countMax;
   }
   
+  if(count != _count){
+    _count = count;
+    #if FADE_LED_INCREMENTAL
+    setupStep();
+    #endif
+  }
 }
+#endif
 
 void FadeLed::setInterval(unsigned int interval){
   _interval = interval;
 }
 
-void FadeLed::update(){
-  unsigned int millisNow = millis();
+unsigned int FadeLed::getInterval(){
+  return _interval;
+}
+
+bool FadeLed::update(){
+  #if FADE_LED_MULTICORE && !FADE_LED_ISR
+  //a task is handling the queue, the next update() does this one
+  if(!lockEngine()){
+    return false;
+  }
+  #endif
   
-  if(!_ledCount){
-    return;
+  #if FADE_LED_STATS
+  unsigned long start = micros();
+  #endif
+  
+  //a new list each update
+  _completedList = nullptr;
+  
+  #if FADE_LED_ELAPSED_TIME
+  unsigned long millisNow = millis();
+  
+  if(millisNow - _millisLast >= _interval){
+    //count every whole interval passed, so no time gets lost
+    unsigned long passed = (millisNow - _millisLast) / _interval;
+    #if FADE_LED_STATS
+    if(passed > 1){
+      _stats.lateTicks++;
+      _stats.skippedIntervals += passed - 1;
+    }
+    #endif
+    _millisLast += passed * _interval;
+    _tick += passed;
+    
+    tick();
   }
+  #elif !FADE_LED_ISR
+  unsigned long millisNow = millis();
   
   if(millisNow - _millisLast > _interval){
     /**
@@ -274,16 +1176,335 @@ void FadeLed::update(){
      *  Weird fade when not calling update() while not fading     
      */
     if(millisNow - _millisLast > (_interval << 1)){
+      #if FADE_LED_STATS
+      _stats.lateTicks++;
+      _stats.resyncs++;
+      _stats.skippedIntervals += (millisNow - _millisLast) / _interval - 1;
+      #endif
       _millisLast = millisNow;
     }
     else{
       _millisLast += _interval;
     }
-        
-    //update every object
-    for(byte i = 0; i < _ledCount; i++){
-      _ledList[i]->updateThis();
+    
+    tick();
+  }
+  #else
+  //take the objects tick() finished
+  #if defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    #if defined(__AVR__)
+    FadeLed* led = _finishedList;
+    _finishedList = nullptr;
+    #else
+    FadeLed* led = __atomic_exchange_n(&_finishedList, nullptr, __ATOMIC_ACQ_REL);
+    #endif
+    
+    while(led){
+      FadeLed* next = led->_nextFinished;
+      if(next == led){
+        next = nullptr;
+      }
+      led->_nextCompleted = _completedList;
+      _completedList = led;
+      
+      //tick() may add it again
+      #if defined(__AVR__)
+      led->_nextFinished = nullptr;
+      #else
+      __atomic_store_n(&led->_nextFinished, (FadeLed*)nullptr, __ATOMIC_RELEASE);
+      #endif
+      led = next;
+    }
+  }
+  #endif
+  
+  //send all changes to the output backends in one go
+  FadeLedOutput::flushAll();
+  
+  #if FADE_LED_STATS
+  unsigned long took = micros() - start;
+  _stats.updates++;
+  _stats.updateMicros += took;
+  if(took > _stats.updateMicrosMax){
+    _stats.updateMicrosMax = took;
+  }
+  #endif
+  
+  #if FADE_LED_MULTICORE && !FADE_LED_ISR
+  unlockEngine();
+  #endif
+  return _completedList != nullptr;
+}
+
+FadeLed* FadeLed::completed(){
+  return _completedList;
+}
+
+FadeLed* FadeLed::nextCompleted(){
+  return _nextCompleted;
+}
+
+void FadeLed::tick(){
+  #if FADE_LED_LOCK && FADE_LED_ISR
+  //a task is handling the queue or an object is destroyed, skip this interval
+  if(!lockEngine()){
+    return;
+  }
+  #endif
+  
+  #if FADE_LED_TRACE
+  FadeLedTrace::record(FadeLedTraceRecord::Tick, 0, 0, micros());
+  #endif
+  
+  #if FADE_LED_STATS
+  unsigned long start = micros();
+  unsigned long updated = _stats.ledsUpdated;
+  #endif
+  
+  #if FADE_LED_QUEUE
+  handleQueue();
+  #endif
+  
+  #if FADE_LED_SCHEDULER && !FADE_LED_ELAPSED_TIME
+  _tick++;
+  #endif
+  
+  #if FADE_LED_MASTER
+  //the fades below write with the new scale
+  bool redim = FadeLedMaster::updateAll();
+  #endif
+  
+  #if FADE_LED_SCHEDULER
+  tickWheel();
+  #else
+  //update every fading object, drop it from the list when done
+  FadeLed** link = &_fadingList;
+  while(*link){
+    FadeLed* led = *link;
+    led->updateThis();
+    
+    if(led->doneNow()){
+      led->_fading = false;
+      *link = led->_nextFading;
+      led->finished();
+    }
+    else{
+      link = &led->_nextFading;
+    }
+  }
+  #endif
+  
+  #if FADE_LED_MASTER
+  if(redim){
+    redimAll();
+  }
+  #endif
+  
+  //the groups, cores, layers and sequences, if the sketch has them
+  for(byte i = 0; i < NrHooks; i++){
+    if(_hooks[i]){
+      _hooks[i]();
+    }
+  }
+  
+  #if FADE_LED_STATS
+  _stats.ticks++;
+  updated = _stats.ledsUpdated - updated;
+  if(updated > _stats.ledsUpdatedMax){
+    _stats.ledsUpdatedMax = updated;
+  }
+  unsigned long took = micros() - start;
+  if(took > _stats.tickMicrosMax){
+    _stats.tickMicrosMax = took;
+  }
+  #endif
+  
+  #if FADE_LED_LOCK && FADE_LED_ISR
+  unlockEngine();
+  #endif
+}
+
+#if FADE_LED_TRACE
+void FadeLed::traceFade(bool known){
+  //ticks until the last step, like the division does it
+  unsigned long ticks = 0;
+  if(known){
+    unsigned long dist = (_setVal > _startVal) ? (_setVal - _startVal) : (_startVal - _setVal);
+    ticks = _countMax;
+    if(!_constTime){
+      ticks = (dist * _countMax + biggestStep() - 1) / biggestStep();
+      #if FADE_LED_EASING
+      //somewhere on the curve
+      if(_easing){
+        ticks = 0;
+      }
+      #endif
     }
   }
+  
+  unsigned long now = micros();
+  FadeLedTrace::record(FadeLedTraceRecord::Fade, _pin, getGamma(_setVal), now);
+  FadeLedTrace::record(FadeLedTraceRecord::Duration, _pin, 0, ticks * _interval);
+}
+#endif
+
+#if FADE_LED_STATS
+FadeLedStats FadeLed::stats(){
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may not change it halfway copying
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+    return _stats;
+  }
+  #endif
+  return _stats;
+}
+
+void FadeLed::resetStats(){
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    _stats = FadeLedStats();
+  }
+}
+#endif
+
+#if FADE_LED_QUEUE
+void FadeLed::push(byte type, unsigned long value, bool flag){
+  pushCommand(this, _queued, type, value, flag);
+}
+
+void FadeLed::pushCommand(void* target, byte& queued, byte type, unsigned long value, bool flag){
+  #if FADE_LED_MULTICORE
+  //take a place, other tasks may take one at the same time
+  byte head = __atomic_load_n(&_queueHead, __ATOMIC_RELAXED);
+  do{
+    //queue full, handle it here if no update is running, otherwise wait for room
+    while((byte)(head - __atomic_load_n(&_queueTail, __ATOMIC_ACQUIRE)) >= FADE_LED_QUEUE_SIZE - 1){
+      if(lockEngine()){
+        handleQueue();
+        unlockEngine();
+      }
+      else{
+        //let update() finish, also if it runs in a task with a lower priority on this core
+        delay(1);
+      }
+      head = __atomic_load_n(&_queueHead, __ATOMIC_RELAXED);
+    }
+  } while(!__atomic_compare_exchange_n(&_queueHead, &head, (byte)(head + 1), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  
+  Command& command = _queue[head & (FADE_LED_QUEUE_SIZE - 1)];
+  command.target = target;
+  command.type = type;
+  command.flag = flag;
+  command.value = value;
+  __atomic_fetch_add(&queued, 1, __ATOMIC_RELAXED);
+  
+  //only now tick() may handle it
+  __atomic_store_n(&command.filled, (byte)true, __ATOMIC_RELEASE);
+  #else
+  byte head = _queueHead;
+  byte next = (head + 1) & (FADE_LED_QUEUE_SIZE - 1);
+  
+  //queue full, wait for tick() to make room
+  while(next == __atomic_load_n(&_queueTail, __ATOMIC_ACQUIRE)){
+  }
+  
+  _queue[head].target = target;
+  _queue[head].type = type;
+  _queue[head].flag = flag;
+  _queue[head].value = value;
+  queued++;
+  
+  //only now tick() may see it
+  __atomic_store_n(&_queueHead, next, __ATOMIC_RELEASE);
+  #endif
+}
+
+void FadeLed::dropCommands(void* target){
+  #if FADE_LED_MULTICORE
+  for(byte i = _queueTail; i != __atomic_load_n(&_queueHead, __ATOMIC_ACQUIRE); i++){
+    Command& command = _queue[i & (FADE_LED_QUEUE_SIZE - 1)];
+    //a place a task took but didn't fill yet can't be for it
+    if(__atomic_load_n(&command.filled, __ATOMIC_ACQUIRE) && command.target == target){
+      command.target = nullptr;
+    }
+  }
+  #else
+  for(byte i = _queueTail; i != _queueHead; i = (i + 1) & (FADE_LED_QUEUE_SIZE - 1)){
+    if(_queue[i].target == target){
+      _queue[i].target = nullptr;
+    }
+  }
+  #endif
+}
+
+void FadeLed::handleQueue(){
+  byte tail = _queueTail;
+  #if FADE_LED_MULTICORE
+  //head and tail count on, up to the first place that isn't filled in yet
+  while(__atomic_load_n(&_queue[tail & (FADE_LED_QUEUE_SIZE - 1)].filled, __ATOMIC_ACQUIRE)){
+    Command& command = _queue[tail & (FADE_LED_QUEUE_SIZE - 1)];
+  #else
+  byte head = __atomic_load_n(&_queueHead, __ATOMIC_ACQUIRE);
+  
+  while(tail != head){
+    Command& command = _queue[tail];
+  #endif
+    void* target = command.target;
+    byte* applied = nullptr;
+    
+    //dropped (nullptr), the object is gone
+    if(target && command.type == CommandScene){
+      FadeLedScene* scene = (FadeLedScene*)target;
+      scene->fadeNow(command.value);
+      applied = &scene->_applied;
+    }
+    else if(target){
+      FadeLed* led = (FadeLed*)target;
+      switch(command.type){
+        case CommandBegin:
+          led->beginNow(command.value);
+          break;
+        case CommandSet:
+          led->setNow(command.value);
+          break;
+        case CommandSetTime:
+          led->setTimeNow(command.value, command.flag);
+          break;
+        case CommandStop:
+          led->stopNow();
+          break;
+        #if FADE_LED_EASING
+        case CommandSetEasing:
+          led->setEasingNow((const uint16_t*)command.value);
+          break;
+        #endif
+        #if FADE_LED_RETARGET
+        case CommandSetRetarget:
+          led->setRetargetNow(command.value);
+          break;
+        #endif
+      }
+      applied = &led->_applied;
+    }
+    if(applied){
+      __atomic_store_n(applied, (byte)(*applied + 1), __ATOMIC_RELEASE);
+    }
+    
+    #if FADE_LED_MULTICORE
+    __atomic_store_n(&command.filled, (byte)false, __ATOMIC_RELAXED);
+    tail++;
+    #else
+    tail = (tail + 1) & (FADE_LED_QUEUE_SIZE - 1);
+    #endif
+  }
+  
+  //give the places back to push()
+  __atomic_store_n(&_queueTail, tail, __ATOMIC_RELEASE);
 }
+#endif
 
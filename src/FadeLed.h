@@ -29,12 +29,14 @@
  *  
  *  @warning Can't simply increase the number to have more PWM levels. It's limited to the hardware.
  */
- #if defined ( ESP8266 )
-  //ESP8266 has 10-bit PWM
-  #define FADE_LED_PWM_BITS 10
-#else
-  //Change this to match the number of PWM bit on other devices
-  #define FADE_LED_PWM_BITS 8
+#ifndef FADE_LED_PWM_BITS
+  #if defined ( ESP8266 )
+    //ESP8266 has 10-bit PWM
+    #define FADE_LED_PWM_BITS 10
+  #else
+    //Change this to match the number of PWM bit on other devices
+    #define FADE_LED_PWM_BITS 8
+  #endif
 #endif
 
 
@@ -53,15 +55,6 @@ typedef uint16_t flvar_t;
 #endif
 
 
-/**
- *  @brief Maximum number of FadeLed objects
- *  
- *  **Default** = 6, the number of hardware PWM pins on an Uno/Pro Mini/Nano
- */
-#ifndef FADE_LED_MAX_LED
-#define FADE_LED_MAX_LED  6
-#endif
-
 /**
  *  @brief The maximum brightness step of the PWM
  *  
@@ -75,7 +68,269 @@ typedef uint16_t flvar_t;
 #define FADE_LED_RESOLUTION ((1 <<FADE_LED_PWM_BITS) -1)
 #endif
 
+/**
+ *  @brief Use the division free fade engine
+ *  
+ *  @details With 1 (**default**) each update() only adds and compares to get the next brightness of a fade. It's set up (with a division) by set() and setTime(). With 0 the brightness is calculated with a multiply and a division each update(). The result is exactly the same, the incremental engine is just faster (especially on AVR) at the cost of 10 (8-bit PWM) or 12 bytes of RAM per FadeLed object.
+ *  
+ *  @note Only a fade that overshoots past the range of #flvar_t in a single update (setTime() far shorter than the interval) can end differently. The division engine gives a result there that even depends on the size of an unsigned long.
+ */
+#ifndef FADE_LED_INCREMENTAL
+#define FADE_LED_INCREMENTAL 1
+#endif
+
+/**
+ *  @brief Enables temporal dithering (see FadeLed::setDither())
+ *  
+ *  @details With 1 a FadeLed object can fade with dithering between the steps of the gamma table. This costs 6 bytes of RAM per FadeLed object (3 with the division engine). **Default** 0, no dithering.
+ *  
+ *  @see FADE_LED_INCREMENTAL
+ */
+#ifndef FADE_LED_DITHER
+#define FADE_LED_DITHER 0
+#endif
+
+/**
+ *  @brief Enables easing curves (see FadeLed::setEasing())
+ *  
+ *  @details With 1 a fade can follow an easing curve from FadeLedEasing.h. Costs a pointer of RAM per FadeLed object (and per FadeLedGroup). **Default** 0, linear fades.
+ */
+#ifndef FADE_LED_EASING
+#define FADE_LED_EASING 0
+#endif
+
+/**
+ *  @brief Enables retargeting of constant time fades (see FadeLed::setRetarget())
+ *  
+ *  @details With 1 set() can give a running constant time fade a new brightness instead of being ignored. The new fade starts with the speed the fade had, it uses the curve machinery of #FADE_LED_EASING for that, so that has to be 1 as well. Costs 9 bytes of RAM per FadeLed object on AVR. **Default** 0, set() is ignored during a constant time fade.
+ */
+#ifndef FADE_LED_RETARGET
+#define FADE_LED_RETARGET 0
+#endif
+
+#if FADE_LED_RETARGET && !FADE_LED_EASING
+  #error FADE_LED_RETARGET needs FADE_LED_EASING
+#endif
+
+/**
+ *  @brief Lets a timer interrupt drive the fading (see FadeLed::tick())
+ *  
+ *  @details With 1 the fading doesn't depend on how often update() is called. Set up a timer interrupt that calls FadeLed::tick() every interval, blocking code in loop() (like delay()) doesn't stop the fades anymore. begin(), set(), setTime() and stop() (and on(), off() etc) then don't change the object directly but put a command in a queue that tick() handles. So tick() never sees a half changed object. **Default** 0, update() does the fading.
+ *  
+ *  Costs the queue (#FADE_LED_QUEUE_SIZE commands of 8 bytes on AVR) and 2 bytes of RAM per FadeLed object.
+ *  
+ *  @see FADE_LED_QUEUE_SIZE
+ */
+#ifndef FADE_LED_ISR
+#define FADE_LED_ISR 0
+#endif
+
+/**
+ *  @brief Number of commands the queue can hold with #FADE_LED_ISR or #FADE_LED_MULTICORE
+ *  
+ *  @details Must be a power of 2 from 2 up to 256 (128 with #FADE_LED_MULTICORE), one place is always kept free. If the queue is full a new command waits until tick() made room. **Default** 8
+ */
+#ifndef FADE_LED_QUEUE_SIZE
+#define FADE_LED_QUEUE_SIZE 8
+#endif
+
+/**
+ *  @brief Lets other cores and tasks change the fades while one core runs update()
+ *  
+ *  @details With 1 begin(), set(), setTime(), stop(), setEasing() and setRetarget() (and on(), off() etc) may be called from any core or task, for example from network tasks on one core of an ESP32 while loop() on the other calls update(). Like with #FADE_LED_ISR they put a command in the queue, but here several tasks can do that at the same time. Only the core that calls update() (or tick() with #FADE_LED_ISR) changes the objects and it never waits: if a task is busy with them it skips that update and the next call does it. get(), getCurrent(), done(), rising() and falling() read a copy of the brightness that's replaced in one go, so they never see half a change.
+ *  
+ *  A task that finds the queue full handles the queue itself if no update is running, otherwise it waits (a ms at a time) until there is room. Make the objects and set everything else (gamma table, output, dither, interval) before the other tasks start. Groups, sequences and FadeLedCore objects are only changed from the core that calls update(). Needs GCC atomics, so not for AVR. **Default** 0.
+ *  
+ *  Costs the queue (#FADE_LED_QUEUE_SIZE commands) and 6 bytes of RAM per FadeLed object.
+ */
+#ifndef FADE_LED_MULTICORE
+#define FADE_LED_MULTICORE 0
+#endif
+
+#if FADE_LED_MULTICORE && defined(__AVR__)
+  #error FADE_LED_MULTICORE is for multi-core boards, use FADE_LED_ISR on AVR
+#endif
+
+/**
+ *  @brief Fade on the time passed instead of on the number of updates
+ *  
+ *  @details With 0 (**default**) each update() that's due moves the fades one interval. If update() is called late (blocking code) the time in between is lost and the fades take longer.
+ *  
+ *  With 1 update() counts every whole interval passed since the last update and each fade is at the brightness for the time passed since it started. A late update() jumps straight to the right brightness (O(1), no matter how late) and a fade ends on time. Costs 4 bytes of RAM per FadeLed object (and per FadeLedGroup). Can't be combined with #FADE_LED_ISR, there tick() is called on time anyway.
+ */
+#ifndef FADE_LED_ELAPSED_TIME
+#define FADE_LED_ELAPSED_TIME 0
+#endif
+
+#if FADE_LED_ISR && FADE_LED_ELAPSED_TIME
+  #error FADE_LED_ISR and FADE_LED_ELAPSED_TIME can not be used together
+#endif
+
+/**
+ *  @brief Only update a fading object on the tick its output changes
+ *  
+ *  @details With 0 (**default**) every fading object is updated every tick. In a slow fade most of those updates don't change the output, like a fade over 101 steps in 60 seconds changes once every 12 ticks (50ms interval).
+ *  
+ *  With 1 each fading object calculates the tick its output changes next (one division per change) and waits in a timing wheel of #FADE_LED_WHEEL_SIZE slots. A tick only updates the objects in its slot. Objects that dither are updated every tick. Costs 2 pointers and 8 bytes of RAM per FadeLed object plus the wheel. Fast fades (a change every tick) get a little slower.
+ *  
+ *  @see FADE_LED_WHEEL_SIZE
+ */
+#ifndef FADE_LED_SCHEDULER
+#define FADE_LED_SCHEDULER 0
+#endif
+
+/**
+ *  @brief Number of slots of the timing wheel of #FADE_LED_SCHEDULER
+ *  
+ *  @details Must be a power of 2. An object that changes more than this number of ticks from now is looked at once every round of the wheel. **Default** 32
+ */
+#ifndef FADE_LED_WHEEL_SIZE
+#define FADE_LED_WHEEL_SIZE 32
+#endif
+
+/**
+ *  @brief Counts what the fade engine does (see FadeLed::stats())
+ *  
+ *  @details With 1 the library keeps counters of the ticks, late updates, time spent in update() and tick(), objects faded and outputs written. Use them to pick the interval (FadeLed::setInterval()) and the number of LEDs a board can handle. Costs 48 bytes of RAM, two calls to micros() per update() and per tick and an increment here and there. **Default** 0, all of it is compiled out.
+ */
+#ifndef FADE_LED_STATS
+#define FADE_LED_STATS 0
+#endif
+
+/**
+ *  @brief Records what's written to the outputs (see FadeLedTrace)
+ *  
+ *  @details With 1 every output write, tick and fade start is put in a ring buffer of #FADE_LED_TRACE_SIZE records with its time (micros()), to find flicker with `extras/TraceAnalyze.py`. Costs 8 bytes of RAM per record and a call to micros() per write. **Default** 0, all of it is compiled out.
+ *  
+ *  @see FADE_LED_TRACE_SIZE
+ */
+#ifndef FADE_LED_TRACE
+#define FADE_LED_TRACE 0
+#endif
+
+/**
+ *  @brief Number of records of #FADE_LED_TRACE
+ *  
+ *  @details Must be a power of 2, at most 32768. **Default** 64 (512 bytes of RAM)
+ */
+#ifndef FADE_LED_TRACE_SIZE
+#define FADE_LED_TRACE_SIZE 64
+#endif
+
+/**
+ *  @brief Packs the state of a FadeLed object to save RAM
+ *  
+ *  @details With 1 the flags of an object are packed in bits, the gamma table is a 1 byte index into a shared list of #FADE_LED_GAMMA_TABLES tables instead of a pointer, a biggest step and the segment bits, and the list of all objects only links forward (destroying an object then walks the list). Together with the narrower counters of #FADE_LED_MAX_INTERVALS (65534 by default in this mode) an object takes 24 instead of 38 bytes on AVR with the defaults and 8-bit PWM. The fading is exactly the same, it's only a little slower. **Default** 0.
+ *  
+ *  RAM of a FadeLed object on AVR (so 2 byte pointers) with the other settings at their default:
+ *  
+ *  | #FADE_LED_PWM_BITS | normal   | compact  |
+ *  |--------------------|----------|----------|
+ *  | 8                  | 38 bytes | 24 bytes |
+ *  | 9 to 16            | 44 bytes | 29 bytes |
+ *  
+ *  #FADE_LED_EASING adds 2 bytes, #FADE_LED_RETARGET 9 more normal and 6 more compact. Counters of 1 byte (#FADE_LED_MAX_INTERVALS 254) save 5 more in compact.
+ *  
+ *  @see FADE_LED_MAX_INTERVALS, FADE_LED_GAMMA_TABLES
+ */
+#ifndef FADE_LED_COMPACT
+#define FADE_LED_COMPACT 0
+#endif
+
+/**
+ *  @brief Longest fade in intervals
+ *  
+ *  @details A longer setTime() is cut to this. The counters of a fade are made just big enough for it: a byte up to 254, 2 bytes up to 65534, otherwise an unsigned long. **Default** 65534 (almost 55 minutes at an interval of 50ms) with #FADE_LED_COMPACT, otherwise 4294967294.
+ */
+#ifndef FADE_LED_MAX_INTERVALS
+  #if FADE_LED_COMPACT
+    #define FADE_LED_MAX_INTERVALS 65534UL
+  #else
+    #define FADE_LED_MAX_INTERVALS 4294967294UL
+  #endif
+#endif
+
+/**
+ *  @brief Sets the variable type of the counters of a fade
+ *  
+ *  @details Is done automatically according to #FADE_LED_MAX_INTERVALS, one more than that must fit.
+ */
+#if FADE_LED_MAX_INTERVALS < 255
+typedef uint8_t flcount_t;
+#elif FADE_LED_MAX_INTERVALS < 65535
+typedef uint16_t flcount_t;
+#else
+typedef unsigned long flcount_t;
+#endif
+
+/**
+ *  @brief Number of different gamma tables with #FADE_LED_COMPACT
+ *  
+ *  @details Two are taken by the default gamma table and by no gamma table (noGammaTable()). Each table takes 5 bytes of RAM (6 for more than 8-bit PWM). A table is found by its address, a table given to setGammaTable() in different files can take a place each. If the list is full setGammaTable() returns false and FadeLed::gammaTablesFull() tells, check it in setup() when using more tables. **Default** 4
+ */
+#ifndef FADE_LED_GAMMA_TABLES
+#define FADE_LED_GAMMA_TABLES 4
+#endif
+
+/**
+ *  @brief Enables master dimmers (see FadeLedMaster)
+ *  
+ *  @details With 1 a FadeLed object can be linked to a FadeLedMaster (setMaster()) that dims its output, and a master to a master above it (global, zone, LED). The brightness of the object is scaled by all its masters just before the gamma correction, its own fade is left alone. Costs a pointer of RAM per FadeLed object and a multiply per output write. **Default** 0.
+ */
+#ifndef FADE_LED_MASTER
+#define FADE_LED_MASTER 0
+#endif
+
+//The library counts ticks for these modes
+#define FADE_LED_TICKS (FADE_LED_ELAPSED_TIME || FADE_LED_SCHEDULER)
+
+//The library queues the commands for these modes
+#define FADE_LED_QUEUE (FADE_LED_ISR || FADE_LED_MULTICORE)
+
+//The objects are taken with a lock instead of with the interrupt off in these modes
+#if FADE_LED_MULTICORE || (FADE_LED_ISR && !defined(__AVR__))
+  #define FADE_LED_LOCK 1
+#else
+  #define FADE_LED_LOCK 0
+#endif
+
+#if FADE_LED_ISR && defined(__AVR__)
+  #include <util/atomic.h>
+#endif
+
 #include "FadeLedGamma.h"
+#include "FadeLedGammaCurve.h"
+#include "FadeLedEasing.h"
+#include "FadeLedStep.h"
+#include "FadeLedOutput.h"
+#if FADE_LED_TRACE
+  #include "FadeLedTrace.h"
+#endif
+#if FADE_LED_MASTER
+  #include "FadeLedMaster.h"
+#endif
+
+#if FADE_LED_STATS
+/**
+ *  @brief Counters of the fade engine, see FadeLed::stats()
+ *  
+ *  @details All counters roll over. Averages are the total divided by the count, like `updateMicros / updates`.
+ */
+struct FadeLedStats{
+  unsigned long updates; //!< Calls to FadeLed::update()
+  unsigned long updateMicros; //!< Total time (us) spent in FadeLed::update()
+  unsigned long updateMicrosMax; //!< Longest FadeLed::update() (us)
+  unsigned long ticks; //!< Calls to FadeLed::tick(), so intervals the fades moved
+  unsigned long tickMicrosMax; //!< Longest FadeLed::tick() (us), with #FADE_LED_ISR the time in the interrupt
+  unsigned long lateTicks; //!< Ticks update() started an interval or more after they were due, not counted with #FADE_LED_ISR
+  unsigned long resyncs; //!< Late ticks that started counting the interval from now (issue #13), not with #FADE_LED_ELAPSED_TIME
+  unsigned long skippedIntervals; //!< Whole intervals passed between a late tick and the tick before, lost (the fades take longer) or with #FADE_LED_ELAPSED_TIME caught up
+  unsigned long ledsUpdated; //!< Objects faded by all ticks, per tick it's `ledsUpdated / ticks`
+  unsigned long ledsUpdatedMax; //!< Most objects faded in one tick
+  unsigned long writes; //!< Outputs written (analogWrite() or an output backend), also by FadeLedGroup, FadeLedCore and FadeLedLayers
+  unsigned long writesSkipped; //!< Updates of a fading object that didn't write because the brightness didn't change
+};
+#endif
 
 /**
  *  @brief Main class of the FadeLed-library
@@ -93,7 +348,9 @@ class FadeLed{
      *  
      *  When created the default brightness is **0**. You can start at a different brightness by calling begin().
      *  
-     *  @note Make all objects global (or static if you really must) because a destruct will lead to errors!
+     *  With #FADE_LED_COMPACT the table takes a place in the list of #FADE_LED_GAMMA_TABLES tables. If the list is full the object uses the default gamma table and gammaTablesFull() returns true.
+     *  
+     *  @note There is no limit on the number of objects and they can be made and destroyed at any time. Each object links itself in the list update() uses, this doesn't use the heap.
      *  
      *  @warning Don't make two objects for the same pin, they will conflict!
      *  
@@ -110,7 +367,7 @@ class FadeLed{
      *  
      *  When created the default brightness is **0**. You can start at a different brightness by calling begin().
      *  
-     *  With this constructor you can supply your own gamma table as gammaLookup. This must be an array of type flvar_t and should be placed in **PROGMEM**. Specify the largest steps in that table as biggestStep. For an example see the 'SineFade.ino' example in the examples folder.
+     *  With this constructor you can supply your own gamma table as gammaLookup. This must be an array of type flvar_t and should be placed in **PROGMEM**. Specify the largest steps in that table as biggestStep. FadeLedGammaCurve makes such a table at compile time. To only shape the fade use setEasing() instead.
      *  
      *  ```C++
      *  //put gamma table in PROGMEM
@@ -119,7 +376,7 @@ class FadeLed{
      *  FadeLed ledCustom = {Pin, myGammaTable, 19};
      *  ```
      *  
-     *  @note Make all objects global (or static if you really must) because a destruct will lead to errors!
+     *  @note There is no limit on the number of objects and they can be made and destroyed at any time. Each object links itself in the list update() uses, this doesn't use the heap.
      *  
      *  @warning Don't make two objects for the same pin, they will conflict!
      *  
@@ -143,10 +400,23 @@ class FadeLed{
      */
     FadeLed(byte pin, bool hasGammaTable);
     
+    /**
+     *  @brief Copy constructor
+     *  
+     *  @details Makes a new object for the same pin with the same settings (gamma table, fade time and mode). It's linked in the update() cycle as a new object and starts at the current brightness of other, without fading.
+     *  
+     *  @param [in] other The FadeLed object to copy
+     */
+    FadeLed(const FadeLed& other);
+    
     /**
      *  @brief Simple destructor of a FadeLed object
      *  
      *  @details Destroy your FadeLed object and removes it from the FadeLed::update() cycle.
+     *  
+     *  Removing it from the list of all objects takes constant time (with #FADE_LED_COMPACT it walks the list). If it's still fading it's also removed from the (shorter) list of fading objects.
+     *  
+     *  With #FADE_LED_ISR or #FADE_LED_MULTICORE the commands for it still in the queue are dropped and tick() can't run meanwhile (on AVR with the interrupt off, otherwise tick() skips an interval). Destroy it from the main program or the core that calls update().
      */
     ~FadeLed();
 
@@ -170,12 +440,14 @@ class FadeLed{
      *  
      *  In **constant fade speed** if the new value is in the same fading direction as were started and the value is not yet passed the fade just continues to the new value
      *  
-     *  In **constant fade time** a new value is **ignored** if the LED is still fading
+     *  In **constant fade time** a new value is **ignored** if the LED is still fading, unless retargeting is on (setRetarget())
      *  
      *  Otherwise the fade is just reset and the LED will start fading to the new brightness.
      *  
      *  @note To make all the fading work you need to call FadeLed::update() **often** in the loop()!
      *  
+     *  @note With #FADE_LED_ISR or #FADE_LED_MULTICORE the new brightness is handled by the next tick(). Until then get() still returns the old value but done() already returns false.
+     *  
      *  @see done(), setTime()
      *  
      *  @param [in] val The brightness to fade to.
@@ -268,6 +540,64 @@ class FadeLed{
      */
     void setTime(unsigned long time, bool constTime = false);
     
+    #if FADE_LED_EASING
+    /**
+     *  @brief Set the easing curve of the fades
+     *  
+     *  @details The curve shapes how the fade moves over its time, like starting slow and ending fast. It's applied to the progress of the fade before the gamma table, so the fade stays gamma correct. FadeLedEasing.h has the curves (FadeLedEaseInSine, FadeLedEaseOutCubic etc), `extras/EasingTable.py` makes a table for your own curve.
+     *  
+     *  In constant fade time the curve spans each fade. In constant fade speed it spans a fade over the full range (0 to getBiggestStep()), a shorter fade stops on the way. The curve is the same for fading up and down, so FadeLedEaseInSine starts slow in both directions.
+     *  
+     *  It costs one table read and two multiplies per update, no division.
+     *  
+     *  @param [in] easing Easing table in PROGMEM, FadeLedEaseLinear (nullptr, **default**) for a linear fade
+     */
+    void setEasing(const uint16_t* easing);
+    #endif
+    
+    #if FADE_LED_RETARGET
+    /**
+     *  @brief What set() does with a new brightness while a constant time fade runs
+     */
+    enum Retarget{
+      RetargetIgnore, //!< Ignore it, the fade runs on (**default**)
+      RetargetRestart, //!< Fade from the current brightness to the new one in the set time (setTime())
+      RetargetRemaining //!< Fade from the current brightness to the new one in the time left of the running fade
+    };
+    
+    /**
+     *  @brief Let set() change the brightness of a running constant time fade
+     *  
+     *  @details By default set() is ignored while fading in constant fade time, so a new brightness has to wait until the fade is done. With retargeting the fade turns to the new brightness on the next update. The new fade starts with the speed (and direction) the LED had, so there is no visible kink: the speed changes smoothly (a cubic Hermite bend on top of the fade and its easing curve) until the fade continues as a normal fade. When reversing the LED first slows down and turns.
+     *  
+     *  ```C++
+     *  led.setTime(1000, true);
+     *  led.setRetarget(FadeLed::RetargetRemaining);
+     *  led.set(80);
+     *  //half a second later, the fade now ends at 20 on the same time
+     *  led.set(20);
+     *  ```
+     *  
+     *  It costs some multiplies and a division per retarget, the fade after that is as fast as a fade with an easing curve.
+     *  
+     *  @param [in] mode One of #Retarget
+     */
+    void setRetarget(byte mode);
+    #endif
+    
+    #if FADE_LED_DITHER
+    /**
+     *  @brief Fade with dithering between the steps
+     *  
+     *  @details With a default 101 step gamma table a slow fade visibly steps, especially at the low end where a step doesn't change the output (1, 1, 1, 2, 2...) and then jumps. With dithering the position of the fade is tracked with 8 extra bits (1/256 of a step). The output is interpolated between the gamma table entries around it and the fraction that's left is dithered over the updates between two adjacent output levels. 
+     *  
+     *  Only works if #FADE_LED_DITHER is 1. While fading with dithering the output is written every update. So it works best with a short interval (setInterval()), otherwise the dithering itself can be seen.
+     *  
+     *  @param [in] dither **true** to fade with dithering, **false** (default) for without.
+     */
+    void setDither(bool dither);
+    #endif
+    
     /**
      *  @brief Returns if the LED is still fading up
      *  
@@ -326,12 +656,73 @@ class FadeLed{
      *  
      *  By default a 101 steps (0-100 aka percentage) table is used with a gamma of 2,3. To generate a table with a different gamma you can use the provided Python script ('FadeLed\extras\GammaTable.py'). (You need to install Python for it to work!) Call it like: `python GammaTable.py Gamma Steps PWMbits [VariableName]`. VariableName is optional. For example `python gamma.py 2.5 50 10` will result in a table with 50 steps (0 - 49) with gamma = 2,5 for a 10-bit PWM. This will be stored in gamma.h and can be copy pasted into your code.
      *  
+     *  For high resolution PWM a smooth curve needs thousands of steps, too big for a full table in flash. A compressed (piecewise linear) table only stores a level (knot) every 2^segmentBits steps and interpolates the steps in between. FadeLedGammaPwlCurve makes one at compile time.
+     *  
+     *  ```C++
+     *  //gamma 2.3 with 4097 steps (0 - 4096), a knot every 64 steps
+     *  typedef FadeLedGammaPwlCurve<2300, 4097, 6> MyCurve;
+     *  
+     *  led.setGammaTable(MyCurve::table, MyCurve::BiggestStep, MyCurve::SegmentBits);
+     *  ```
+     *  
+     *  With #FADE_LED_COMPACT the table takes a place in the list of #FADE_LED_GAMMA_TABLES tables. If the list is full the object keeps the table it has and it returns false.
+     *  
      *  @note It stops and resets but does **not** change the PWM output. This only gets changed after a new call to set(), on(), off(), begin() or beginOn(). If no action is taken an abrupt jump will happen if not at zero brightness.
      *  
      *  @param [in] table The gamma table in PROGMEM
      *  @param [in] biggestStep The biggest step of that gamma table (aka size -1) If no parameter is used 100 is assumed to be the top value possible.
+     *  @param [in] segmentBits 0 (default) for a full table. For a compressed table the table has a knot every 2^segmentBits steps, (biggestStep >> segmentBits) + 1 knots.
+     *  
+     *  @return **false** if with #FADE_LED_COMPACT the list of gamma tables is full, **true** otherwise
+     */
+    bool setGammaTable(const flvar_t* table, flvar_t biggestStep = 100, byte segmentBits = 0);
+    
+    /**
+     *  @brief Write the output to an output backend
+     *  
+     *  @details Instead of analogWrite() the brightness is written to a channel of output. The pin given to the constructor is used as that channel. The output is send by update() once per update for all changed channels together.
+     *  
+     *  ```C++
+     *  Pca9685 pwmDriver;
+     *  FadeLed led(3); //channel 3
+     *  
+     *  void setup(){
+     *    led.setOutput(&pwmDriver);
+     *  }
+     *  ```
+     *  
+     *  @param [in] output The output to write to, nullptr to use analogWrite() again
+     *  
+     *  @see FadeLedOutput
+     */
+    void setOutput(FadeLedOutput* output);
+    
+    #if FADE_LED_MASTER
+    /**
+     *  @brief Dim the output with a master dimmer
+     *  
+     *  @details The brightness of this object is scaled by the master (and the masters above it) before the gamma correction. The fade of this object is not changed: get(), getCurrent() and done() don't see the master. Only available with #FADE_LED_MASTER 1. With #FADE_LED_ISR or #FADE_LED_MULTICORE only call it when the timer interrupt can't run or from the core that calls update().
+     *  
+     *  ```C++
+     *  FadeLedMaster house;
+     *  FadeLedMaster kitchen(&house);
+     *  FadeLed led(5);
+     *  
+     *  void setup(){
+     *    led.setMaster(&kitchen);
+     *    kitchen.set(128); //half, the fade of led goes on
+     *  }
+     *  ```
+     *  
+     *  @param [in] master The master, nullptr for none
      */
-    void setGammaTable(const flvar_t* table, flvar_t biggestStep = 100);
+    void setMaster(FadeLedMaster* master);
+    
+    /**
+     *  @brief Returns the master dimmer, nullptr if it has none
+     */
+    FadeLedMaster* getMaster();
+    #endif
     
     /**
      *  @brief Use no gamma correction for full range
@@ -371,6 +762,10 @@ class FadeLed{
      *  
      *  @details This is the core function of FadeLed. Calling this function will check each object of FadeLed to see if the brightness needs changing (fade). 
      *  
+     *  Only objects that are fading are checked. They start when set() gives them a new brightness to fade to and stop once they reach it. So objects that are done fading cost nothing. If none is fading an update is just the check of the time.
+     *  
+     *  At the end each output backend (FadeLedOutput) with changed channels is flushed once.
+     *  
      *  It's a static function, you only need to call it once for all objects of FadeLed. You can call it using the class name like:
      *  
      *  ```C++    
@@ -381,8 +776,92 @@ class FadeLed{
      *  
      *  @note Call this function **often** in order not to skip steps. Make the code non-blocking aka **don't** use delay() anywhere! See [Blink Without Delay()](https://www.arduino.cc/en/Tutorial/BlinkWithoutDelay)
      *  
+     *  @note With #FADE_LED_ISR the fading is done by tick() and update() only flushes the output backends and collects the finished fades for completed(). So it's only needed if you use a FadeLedOutput or completed().
+     *  
+     *  @return true if a fade finished in this update, see completed()
+     */
+    static bool update();
+    
+    /**
+     *  @brief First object that finished fading in the last update()
+     *  
+     *  @details Instead of checking done() of every object every loop, only look at the objects that finished. An object is in the list if done() became true in that update, also after stop() or begin() while fading. The list is new every update().
+     *  
+     *  ```C++
+     *  loop(){
+     *    if(FadeLed::update()){
+     *      for(FadeLed* led = FadeLed::completed(); led; led = led->nextCompleted()){
+     *        //led just finished
+     *      }
+     *    }
+     *  }
+     *  ```
+     *  
+     *  With #FADE_LED_ISR it's the objects that finished in tick() since the last update(). An object that finishes again while update() collects it is only reported the first time.
+     *  
+     *  @return The first object, nullptr if none finished
      */
-    static void update();
+    static FadeLed* completed();
+    
+    /**
+     *  @brief Next object that finished fading in the last update()
+     *  
+     *  @see completed()
+     *  
+     *  @return The next object, nullptr if this was the last
+     */
+    FadeLed* nextCompleted();
+    
+    /**
+     *  @brief Does one interval of fading for all FadeLed objects
+     *  
+     *  @details Called by update() once every interval. With #FADE_LED_ISR call it from a timer interrupt every interval instead. It first handles the commands in the queue (from set() etc) and then fades all fading FadeLed objects and groups one interval and starts the next keyframe of sequences (FadeLedSequence) that finished one. For example on an Uno with an interval of 10ms:
+     *  
+     *  ```C++
+     *  //In setup(), use the compare match of the millis() timer, fires every 1.024ms
+     *  OCR0A = 0x80;
+     *  TIMSK0 |= _BV(OCIE0A);
+     *  
+     *  ISR(TIMER0_COMPA_vect){
+     *    static byte count = 0;
+     *    if(++count >= 10){
+     *      count = 0;
+     *      FadeLed::tick();
+     *    }
+     *  }
+     *  ```
+     *  
+     *  It does not flush the output backends (FadeLedOutput), that's left to update() because a bus transfer doesn't belong in an interrupt.
+     *  
+     *  @warning With #FADE_LED_ISR only begin(), set(), setTime(), stop(), setEasing() and setRetarget() (and the functions using them) may be used while the timer runs. Set everything else (gamma table, output, dither, interval) and make the objects before starting the timer. Don't call set() etc with interrupts disabled when the queue might be full, it waits for tick() to make room.
+     */
+    static void tick();
+    
+    #if FADE_LED_STATS
+    /**
+     *  @brief Returns the counters of the fade engine
+     *  
+     *  @details Only with #FADE_LED_STATS. For example print them every few seconds:
+     *  
+     *  ```C++
+     *  FadeLedStats stats = FadeLed::stats();
+     *  Serial.print(stats.updateMicros / stats.updates);
+     *  Serial.print("us per update, max ");
+     *  Serial.print(stats.updateMicrosMax);
+     *  Serial.print("us, late ticks ");
+     *  Serial.println(stats.lateTicks);
+     *  FadeLed::resetStats();
+     *  ```
+     *  
+     *  @return A copy of the counters
+     */
+    static FadeLedStats stats();
+    
+    /**
+     *  @brief Sets all counters of stats() to 0
+     */
+    static void resetStats();
+    #endif
     
     /**
      *  @brief Sets the interval at which to update the fading
@@ -399,16 +878,134 @@ class FadeLed{
      */
     static void setInterval(unsigned int interval);
     
+    /**
+     *  @brief Returns the interval between updates
+     *  
+     *  @see setInterval()
+     *  
+     *  @return Interval in ms
+     */
+    static unsigned int getInterval();
+    
+    /**
+     *  @brief Returns if a gamma table didn't fit the list of #FADE_LED_COMPACT
+     *  
+     *  @details Once a constructor or setGammaTable() found the list of #FADE_LED_GAMMA_TABLES tables full it stays true. An object made then uses the default gamma table, setGammaTable() keeps the table the object has. Always false without #FADE_LED_COMPACT.
+     *  
+     *  @return **true** if a gamma table didn't fit, make #FADE_LED_GAMMA_TABLES bigger
+     */
+    static bool gammaTablesFull();
+    
+  friend class FadeLedGroupBase;
+  template <byte Channels> friend class FadeLedGroup;
+  friend class FadeLedSequence;
+  friend class FadeLedCoreBase;
+  template <byte Bits, unsigned long Steps, class Gamma> friend class FadeLedCore;
+  friend class FadeLedScene;
+  friend class FadeLedLayersBase;
+  #if FADE_LED_MASTER
+  friend class FadeLedMaster;
+  #endif
+  
   protected:
     const byte _pin; //!< PWM pin to control
     flvar_t _setVal; //!< The brightness to which last set to fade to
     flvar_t _startVal; //!< The brightness at which the new fade needs to start
     flvar_t _curVal; //!< Current brightness
+    #if FADE_LED_COMPACT
+    bool _constTime : 1; //!< Constant time fade or just constant speed fade
+    bool _fading : 1; //!< In the list of fading objects
+    #if FADE_LED_RETARGET
+    byte _retarget : 2; //!< What set() does while a constant time fade runs, one of #Retarget
+    #endif
+    #else
     bool _constTime; //!< Constant time fade or just constant speed fade
-    unsigned long _countMax; //!< The number of #_interval's a fade should take
-    unsigned long _count; //!< The number of #_interval's passed
+    bool _fading; //!< In the list of fading objects
+    #if FADE_LED_RETARGET
+    byte _retarget; //!< What set() does while a constant time fade runs, one of #Retarget
+    #endif
+    #endif
+    flcount_t _countMax; //!< The number of #_interval's a fade should take
+    flcount_t _count; //!< The number of #_interval's passed
+    #if FADE_LED_TICKS
+    unsigned long _startTick; //!< #_tick at which the fade started
+    #endif
+    #if FADE_LED_COMPACT
+    byte _gamma; //!< Index of the gamma table in #_gammaTables
+    #else
     const flvar_t* _gammaLookup; //!< Pointer to the Gamma table in PROGMEM
     flvar_t _biggestStep; //!< The biggest input step possible
+    byte _gammaSegmentBits; //!< 0 for a full gamma table, otherwise a knot every 2^#_gammaSegmentBits steps
+    #endif
+    #if FADE_LED_INCREMENTAL
+    FadeLedStep<flvar_t> _step; //!< Steps faded at #_count and what to add each #_interval
+    #endif
+    #if FADE_LED_DITHER
+    bool _dither; //!< Fade with dithering
+    byte _ditherErr; //!< Part of an output level (1/256) that's not written yet
+    #if FADE_LED_INCREMENTAL
+    unsigned long _ditherScale; //!< 2^24 / #_countMax, to get 1/256 steps from the remainder of #_step
+    #endif
+    #endif
+    #if FADE_LED_EASING
+    const uint16_t* _easing; //!< Easing table in PROGMEM, nullptr for linear
+    #endif
+    #if FADE_LED_RETARGET
+    long _bend; //!< Steps of speed at the start of a retargeted fade more than the fade itself has, 0 for a normal fade
+    flcount_t _countSet; //!< The number of #_interval's set with setTime(), #_countMax is less for a fade retargeted with #RetargetRemaining
+    #endif
+    FadeLedOutput* _output; //!< Output backend, nullptr for analogWrite()
+    #if FADE_LED_MASTER
+    FadeLedMaster* _master; //!< Master dimmer, nullptr for none
+    #endif
+    FadeLed* _nextFading; //!< Next object in the list of fading objects
+    #if FADE_LED_SCHEDULER
+    FadeLed* _prevFading; //!< Previous object in the same slot of the wheel, nullptr if first
+    unsigned long _dueTick; //!< Tick the output changes next
+    #endif
+    FadeLed* _nextCompleted; //!< Next object in the list of completed()
+    #if FADE_LED_ISR
+    FadeLed* _nextFinished; //!< Next object finished in tick() that update() didn't collect yet, the last points to itself, nullptr if not in that list
+    #endif
+    #if !FADE_LED_COMPACT
+    FadeLed* _prevLed; //!< Previous object in the list of all objects
+    #endif
+    FadeLed* _nextLed; //!< Next object in the list of all objects
+    #if FADE_LED_QUEUE
+    byte _queued; //!< Number of commands put in the queue (rolls over), only changed by push()
+    byte _applied; //!< Number of commands handled by tick() (rolls over), only changed by tick()
+    #endif
+    #if FADE_LED_MULTICORE
+    uint32_t _shown; //!< #_setVal (high half) and #_curVal (low half) for the other cores, replaced in one go by publish()
+    #endif
+    #if FADE_LED_QUEUE
+    /**
+     *  @brief A command from the main program for tick()
+     */
+    struct Command{
+      void* target; //!< FadeLed object to change, the FadeLedScene for #CommandScene, nullptr if the object was destroyed
+      byte type; //!< What to do, one of #CommandType
+      bool flag; //!< constTime for setTime()
+      #if FADE_LED_MULTICORE
+      byte filled; //!< push() filled it in, tick() may handle it
+      #endif
+      unsigned long value; //!< Brightness or time
+    };
+    
+    /**
+     *  @brief Types of a Command
+     */
+    enum CommandType{
+      CommandNone,
+      CommandBegin,
+      CommandSet,
+      CommandSetTime,
+      CommandStop,
+      CommandSetEasing,
+      CommandSetRetarget,
+      CommandScene
+    };
+    #endif
 
     
     
@@ -425,7 +1022,7 @@ class FadeLed{
     /**
      *  @Brief Gives the output level for a given gamma step
      *  
-     *  @details Looks it up in the PROGMEM gamma table for this object if table is assigned. Deals with the variable size used.
+     *  @details Looks it up in the PROGMEM gamma table for this object if table is assigned. Deals with the variable size used and with compressed tables (see FadeLedGammaRead()).
      *  
      *  Can't be called directly (it's protected) but it's inline for speed. If you want to get a gamma value for a given step, use getGammaValue() instead.
      *  
@@ -440,23 +1037,459 @@ class FadeLed{
      */
     flvar_t getGamma(flvar_t step);
     
-    static FadeLed* _ledList[FADE_LED_MAX_LED]; //!< array of pointers to all FadeLed objects
-    static byte _ledCount; //!< Next number of FadeLed object
+    /**
+     *  @brief The gamma table in PROGMEM, nullptr for none
+     */
+    const flvar_t* gammaLookup() const;
+    
+    /**
+     *  @brief The biggest input step possible
+     */
+    flvar_t biggestStep() const;
+    
+    /**
+     *  @brief 0 for a full gamma table, otherwise a knot every 2^segmentBits steps
+     */
+    byte gammaSegmentBits() const;
+    
+    #if FADE_LED_COMPACT
+    /**
+     *  @brief Finds a gamma table in #_gammaTables or adds it
+     *  
+     *  @return Index of the table, #FADE_LED_GAMMA_TABLES if the list is full
+     */
+    static byte findGammaTable(const flvar_t* table, flvar_t biggestStep, byte segmentBits);
+    #endif
+    
+    /**
+     *  @brief Writes an output level to the pin or output backend
+     *  
+     *  @param [in] val Output level (so after gamma correction)
+     */
+    void write(flvar_t val);
+    
+    /**
+     *  @brief Writes an output level to a pin or an output backend
+     *  
+     *  @details The one place every output goes through, also of FadeLedGroup, FadeLedCore and FadeLedLayers. Counts it in stats() and records it in the trace.
+     *  
+     *  @param [in] output The output backend, nullptr for analogWrite()
+     *  @param [in] pin    The pin (or channel of output)
+     *  @param [in] val    Output level (so after gamma correction)
+     */
+    static void writeOutput(FadeLedOutput* output, byte pin, flvar_t val);
+    
+    /**
+     *  @brief Output level of a step, dimmed by the masters with #FADE_LED_MASTER
+     *  
+     *  @details Without a master (or with all masters full on) it's getGamma().
+     */
+    flvar_t outputLevel(flvar_t step);
+    
+    #if FADE_LED_MASTER
+    /**
+     *  @brief Output level of a step scaled by the masters
+     *  
+     *  @details The scaled step falls between two steps, the output level is interpolated between those.
+     */
+    flvar_t dimmedLevel(flvar_t step);
+    
+    /**
+     *  @brief Returns if the masters changed the scale this tick
+     *  
+     *  @details Then the output is written by redimAll(), after all fades.
+     */
+    bool masterChanged();
+    
+    /**
+     *  @brief Writes every object of which the masters changed the scale this tick
+     */
+    static void redimAll();
+    #endif
+    
+    /**
+     *  @brief Adds this object to the list of fading objects
+     *  
+     *  @details Only objects in that list are updated by update(). It leaves the list in update() once it's done fading. Does nothing if already in the list, except with #FADE_LED_SCHEDULER where the object is then due on the next tick again.
+     */
+    void startFading();
+    
+    /**
+     *  @brief Adds this object to the finished objects for completed()
+     *  
+     *  @details Called by tick() when the object leaves the fading objects.
+     */
+    void finished();
+    
+    #if FADE_LED_SCHEDULER
+    /**
+     *  @brief Puts this object in the slot of the wheel of a tick
+     *  
+     *  @param [in] due Tick to update it
+     */
+    void schedule(unsigned long due);
+    
+    /**
+     *  @brief Takes this object out of the wheel
+     */
+    void unschedule();
+    
+    /**
+     *  @brief Gives the tick the output changes next
+     *  
+     *  @details The first #_count the fade moves a step from the step written last. Called after updateThis(), so #_count is the count of the next tick. The incremental engine is moved to that count right away (one division), the division engine needs two divisions. If the fade changes before that tick catchUp() sets the engine back.
+     */
+    unsigned long nextChange();
+    
+    /**
+     *  @brief Updates the objects in the slots of the ticks passed
+     */
+    static void tickWheel();
+    #endif
+    
+    #if FADE_LED_INCREMENTAL
+    /**
+     *  @brief Sets up the incremental engine for the current #_count
+     *  
+     *  @details Sets up #_step with the distance of the fade. Needs to be called when a fade starts and when #_countMax or the fade mode changes while fading.
+     */
+    void setupStep();
+    #endif
+    
+    #if FADE_LED_DITHER
+    /**
+     *  @brief Writes the dithered output
+     *  
+     *  @details Interpolates the output between #_curVal and the next step in the fading direction and dithers the fraction left.
+     *  
+     *  @param [in] up **true** if fading up
+     */
+    void writeDither(bool up);
+    #endif
+    
+    /**
+     *  @brief Adds this object to the end of the list of all objects
+     */
+    void link();
+    
+    /**
+     *  @brief Takes this object out of every list and the queue
+     *  
+     *  @details Called by the destructor with tick() kept out.
+     */
+    void unlink();
+    
+    /**
+     *  @brief Implementation of begin(), changes the object directly
+     */
+    void beginNow(flvar_t val);
+    
+    /**
+     *  @brief Implementation of set(), changes the object directly
+     */
+    void setNow(flvar_t val);
+    
+    /**
+     *  @brief Implementation of setTime(), changes the object directly
+     */
+    void setTimeNow(unsigned long time, bool constTime);
+    
+    /**
+     *  @brief Implementation of stop(), changes the object directly
+     */
+    void stopNow();
+    
+    /**
+     *  @brief Starts a constant time fade of a scene, changes the object directly
+     *  
+     *  @details Like setTimeNow(time, true) and setNow(val), but a running fade is always replaced and all objects of the scene share the count and start tick. Used by FadeLedScene.
+     *  
+     *  @param [in] val       Brightness to fade to, limited to getBiggestStep()
+     *  @param [in] countMax  Intervals the fade takes
+     *  @param [in] startTick Tick the fade starts, only used with #FADE_LED_TICKS
+     */
+    void startScene(flvar_t val, flcount_t countMax, unsigned long startTick);
+    
+    /**
+     *  @brief Returns if the fade follows a curve instead of a straight line
+     *  
+     *  @details With an easing curve or a retargeted fade the engine counts the progress of the fade (to #FADE_LED_RESOLUTION) instead of steps and curvePos() makes the steps from that. Always false without #FADE_LED_EASING.
+     */
+    bool curved();
+    
+    #if FADE_LED_EASING
+    /**
+     *  @brief Implementation of setEasing(), changes the object directly
+     */
+    void setEasingNow(const uint16_t* easing);
+    
+    /**
+     *  @brief Position of the fade on the curve
+     *  
+     *  @details Eases the progress (the steps of #_step, which counts to #FADE_LED_RESOLUTION on a curve, or #_count / #_countMax) and scales it to the distance of the fade. With #FADE_LED_RETARGET the bend of a retargeted fade is added, that can make it negative.
+     *  
+     *  @return Steps faded in 1/256 steps
+     */
+    long curvePos();
+    
+    /**
+     *  @brief Brightness at the position of the fade on the curve
+     *  
+     *  @param [in] up The fade goes up
+     *  @return The brightness, limited to 0 to biggestStep()
+     */
+    flvar_t curveVal(bool up);
+    #endif
+    
+    #if FADE_LED_RETARGET
+    /**
+     *  @brief Implementation of setRetarget(), changes the object directly
+     */
+    void setRetargetNow(byte mode);
+    
+    /**
+     *  @brief Sets up a retarget of the running constant time fade
+     *  
+     *  @details Sets #_countMax and #_bend of the new fade to val so it starts with the speed the running fade has now. Call before setNow() starts the new fade.
+     *  
+     *  @param [in] val The new brightness to fade to
+     */
+    void retarget(flvar_t val);
+    #endif
+    
+    /**
+     *  @brief done() without looking at the queue
+     */
+    bool doneNow();
+    
+    #if FADE_LED_TRACE
+    /**
+     *  @brief Records the start of a fade in the trace
+     *  
+     *  @param [in] known The duration is known, false for a fade that got a further brightness
+     */
+    void traceFade(bool known);
+    #endif
+    
+    #if FADE_LED_QUEUE
+    /**
+     *  @brief Puts a command for this object in the queue
+     *  
+     *  @details With #FADE_LED_ISR only called from the main program (single producer). With #FADE_LED_MULTICORE from any task, each takes its own place first. Waits if the queue is full.
+     */
+    void push(byte type, unsigned long value, bool flag = false);
+    
+    /**
+     *  @brief Puts a command in the queue
+     *  
+     *  @details Does the work of push(), also for a FadeLedScene.
+     *  
+     *  @param [in] target The FadeLed object (or FadeLedScene) to change
+     *  @param [in,out] queued The number of commands queued for it
+     */
+    static void pushCommand(void* target, byte& queued, byte type, unsigned long value, bool flag);
+    
+    /**
+     *  @brief Drops the commands for an object tick() didn't handle yet
+     *  
+     *  @details Called by the destructor of a FadeLed object or a FadeLedScene with tick() kept out.
+     *  
+     *  @param [in] target The FadeLed object (or FadeLedScene) that goes
+     */
+    static void dropCommands(void* target);
+    
+    /**
+     *  @brief Handles all commands in the queue
+     *  
+     *  @details Only called from tick() (single consumer). With #FADE_LED_MULTICORE it stops at a place a task took but didn't fill yet.
+     */
+    static void handleQueue();
+    
+    //the places are masked and counted in a byte, with #FADE_LED_MULTICORE the head and tail run on so their difference must fit
+    static_assert(FADE_LED_QUEUE_SIZE >= 2 && (FADE_LED_QUEUE_SIZE & (FADE_LED_QUEUE_SIZE - 1)) == 0 &&
+                  FADE_LED_QUEUE_SIZE <= (FADE_LED_MULTICORE ? 128 : 256),
+                  "FADE_LED_QUEUE_SIZE must be a power of 2 from 2 up to 256 (128 with FADE_LED_MULTICORE)");
+    static Command _queue[FADE_LED_QUEUE_SIZE]; //!< Ring buffer of commands
+    static byte _queueHead; //!< Place for the next command, only changed by push()
+    static byte _queueTail; //!< Next command to handle, only changed by handleQueue()
+    #endif
+    
+    /**
+     *  @brief Makes #_setVal and #_curVal visible to the other cores
+     *  
+     *  @details Called after every change of them, does nothing without #FADE_LED_MULTICORE.
+     */
+    void publish();
+    
+    #if FADE_LED_LOCK
+    /**
+     *  @brief Takes the objects for update(), tick(), a task handling a full queue or the destructor
+     *  
+     *  @details Never waits.
+     *  
+     *  @return false if someone else has them
+     */
+    static bool lockEngine();
+    
+    /**
+     *  @brief Gives the objects back
+     */
+    static void unlockEngine();
+    
+    static bool _engineBusy; //!< update(), tick(), a task or the destructor is changing the objects
+    #endif
+    
+    static FadeLed* _ledFirst; //!< First of all FadeLed objects
+    static FadeLed* _ledLast; //!< Last of all FadeLed objects
+    #if FADE_LED_COMPACT
+    /**
+     *  @brief A gamma table in the list of #FADE_LED_COMPACT
+     */
+    struct GammaTable{
+      const flvar_t* lookup; //!< Gamma table in PROGMEM, nullptr for none
+      flvar_t biggestStep; //!< The biggest input step of it, 0 for an unused place
+      byte segmentBits; //!< 0 for a full table, otherwise a knot every 2^segmentBits steps
+    };
+    static GammaTable _gammaTables[FADE_LED_GAMMA_TABLES]; //!< Gamma tables in use, the first is the default table, the second no table
+    static bool _gammaTablesFull; //!< A table didn't fit #_gammaTables
+    #endif
+    static FadeLed* _fadingList; //!< First object that's fading (not done())
+    static FadeLed* _completedList; //!< First object of completed()
+    #if FADE_LED_ISR
+    static FadeLed* _finishedList; //!< First object finished in tick() that update() didn't collect yet
+    #endif
+    
+    /**
+     *  @brief The classes that fade from tick() next to FadeLed, in the order tick() updates them
+     */
+    enum Hook{
+      HookGroup,
+      HookCore,
+      HookLayers,
+      HookSequence, //!< Last, starts the next keyframes of the fades that just finished
+      NrHooks
+    };
+    
+    static void (*_hooks[NrHooks])(); //!< updateAll() of each #Hook, set by its constructor so only the classes a sketch uses are linked
+    #if FADE_LED_SCHEDULER
+    //the slot of a tick is masked
+    static_assert(FADE_LED_WHEEL_SIZE >= 1 && (FADE_LED_WHEEL_SIZE & (FADE_LED_WHEEL_SIZE - 1)) == 0,
+                  "FADE_LED_WHEEL_SIZE must be a power of 2");
+    static FadeLed* _wheel[FADE_LED_WHEEL_SIZE]; //!< Fading objects by the tick they're due (modulo the size)
+    static unsigned long _wheelTick; //!< Last tick the wheel handled
+    #endif
+    #if FADE_LED_STATS
+    static FadeLedStats _stats; //!< Counters of stats()
+    #endif
     static unsigned int _interval; //!< Interval (in ms) between updates
-    static unsigned int _millisLast; //!< Last time all FadeLed objects where updated
+    static unsigned long _millisLast; //!< Last time all FadeLed objects where updated
+    #if FADE_LED_TICKS
+    static unsigned long _tick; //!< Number of whole #_interval's counted by update() (rolls over)
+    
+    /**
+     *  @brief The tick it is now
+     *  
+     *  @details With #FADE_LED_ELAPSED_TIME #_tick plus the whole intervals passed since the last update(), otherwise #_tick. A fade started now has passed one interval at the next tick.
+     */
+    static unsigned long currentTick();
+    
+    /**
+     *  @brief Moves #_count to the intervals passed since the fade started
+     *  
+     *  @details Only does something if update() was late (or early) or the object waited in the wheel of #FADE_LED_SCHEDULER. Then the incremental engine is set up again for the new #_count, so a fade catches up in one go.
+     */
+    void catchUp();
+    #endif
 };
 
-inline flvar_t FadeLed::getGamma(flvar_t step){
-  if(_gammaLookup == nullptr){
-    return step;
+inline void FadeLed::write(flvar_t val){
+  writeOutput(_output, _pin, val);
+}
+
+inline void FadeLed::writeOutput(FadeLedOutput* output, byte pin, flvar_t val){
+  #if FADE_LED_STATS
+  _stats.writes++;
+  #endif
+  #if FADE_LED_TRACE
+  FadeLedTrace::record(FadeLedTraceRecord::Write, pin, val, micros());
+  #endif
+  if(output){
+    output->write(pin, val);
   }
   else{
-    #if FADE_LED_PWM_BITS <= 8
-      return pgm_read_byte_near(_gammaLookup + step);
-    #else
-      return pgm_read_word_near(_gammaLookup + step);
-    #endif
+    analogWrite(pin, val);
   }
 }
 
+inline flvar_t FadeLed::outputLevel(flvar_t step){
+  #if FADE_LED_MASTER
+  if(_master && _master->_scale != FadeLedMaster::One){
+    return dimmedLevel(step);
+  }
+  #endif
+  return getGamma(step);
+}
+
+#if FADE_LED_MASTER
+inline bool FadeLed::masterChanged(){
+  return _master && _master->_changed;
+}
+#endif
+
+inline void FadeLed::publish(){
+  #if FADE_LED_MULTICORE
+  __atomic_store_n(&_shown, ((uint32_t)_setVal << 16) | _curVal, __ATOMIC_RELEASE);
+  #endif
+}
+
+#if FADE_LED_LOCK
+inline bool FadeLed::lockEngine(){
+  return !__atomic_test_and_set(&_engineBusy, __ATOMIC_ACQUIRE);
+}
+
+inline void FadeLed::unlockEngine(){
+  __atomic_clear(&_engineBusy, __ATOMIC_RELEASE);
+}
+#endif
+
+inline flvar_t FadeLed::getGamma(flvar_t step){
+  #if FADE_LED_COMPACT
+  const GammaTable& table = _gammaTables[_gamma];
+  return FadeLedGammaRead(table.lookup, table.segmentBits, step);
+  #else
+  return FadeLedGammaRead(_gammaLookup, _gammaSegmentBits, step);
+  #endif
+}
+
+inline const flvar_t* FadeLed::gammaLookup() const{
+  #if FADE_LED_COMPACT
+  return _gammaTables[_gamma].lookup;
+  #else
+  return _gammaLookup;
+  #endif
+}
+
+inline flvar_t FadeLed::biggestStep() const{
+  #if FADE_LED_COMPACT
+  return _gammaTables[_gamma].biggestStep;
+  #else
+  return _biggestStep;
+  #endif
+}
+
+inline byte FadeLed::gammaSegmentBits() const{
+  #if FADE_LED_COMPACT
+  return _gammaTables[_gamma].segmentBits;
+  #else
+  return _gammaSegmentBits;
+  #endif
+}
+
+#include "FadeLedGroup.h"
+#include "FadeLedSequence.h"
+#include "FadeLedBam.h"
+#include "FadeLedCore.h"
+#include "FadeLedScene.h"
+#include "FadeLedLayers.h"
+
 #endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+#include "FadeLedBam.h"
+
+#if defined(portOutputRegister)
+
+FadeLedBamBase::FadeLedBamBase(flvar_t* frame, byte channels, byte* pins, byte* chanPort, FadeLedBamPort* chanMask,
+                               volatile FadeLedBamPort** regs, FadeLedBamPort* masks, FadeLedBamPort* planes, byte ports, byte bits) :
+  FadeLedOutput(frame, channels),
+  _pins(pins),
+  _chanPort(chanPort),
+  _chanMask(chanMask),
+  _regs(regs),
+  _masks(masks),
+  _planes(planes),
+  _maxPorts(ports),
+  _bits(bits),
+  _ports(0),
+  _bit(0),
+  _active(0),
+  _ready(false),
+  _swapping(false)
+{
+  for(unsigned int i = 0; i < 2U * _bits * _maxPorts; i++){
+    _planes[i] = 0;
+  }
+}
+
+bool FadeLedBamBase::begin(){
+  byte ports = 0;
+  for(byte ch = 0; ch < _channels; ch++){
+    volatile FadeLedBamPort* reg = portOutputRegister(digitalPinToPort(_pins[ch]));
+    byte port = 0;
+    while(port < ports && _regs[port] != reg){
+      port++;
+    }
+    if(port == ports){
+      if(ports == _maxPorts){
+        return false;
+      }
+      _regs[port] = reg;
+      _masks[port] = 0;
+      ports++;
+    }
+    _chanPort[ch] = port;
+    _chanMask[ch] = digitalPinToBitMask(_pins[ch]);
+    _masks[port] |= _chanMask[ch];
+    digitalWrite(_pins[ch], LOW);
+    pinMode(_pins[ch], OUTPUT);
+  }
+
+  //start with the current frame
+  flush(0, _channels - 1);
+  _ports = ports;
+  return true;
+}
+
+unsigned int FadeLedBamBase::isr(){
+  //new frame only at the start of a cycle
+  if(!_bit && __atomic_load_n(&_ready, __ATOMIC_ACQUIRE)){
+    //tell flush() first, then look again, a flush() that started meanwhile waits or sees it's not taken
+    __atomic_store_n(&_swapping, (byte)true, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&_ready, __ATOMIC_SEQ_CST)){
+      __atomic_store_n(&_active, (byte)(_active ^ 1), __ATOMIC_RELEASE);
+      __atomic_store_n(&_ready, (byte)false, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&_swapping, (byte)false, __ATOMIC_RELEASE);
+  }
+
+  const FadeLedBamPort* plane = _planes + (_active * _bits + _bit) * _maxPorts;
+  for(byte p = 0; p < _ports; p++){
+    volatile FadeLedBamPort* reg = _regs[p];
+    *reg = (*reg & ~_masks[p]) | plane[p];
+  }
+
+  unsigned int units = 1U << _bit;
+  if(++_bit == _bits){
+    _bit = 0;
+  }
+  return units;
+}
+
+byte FadeLedBamBase::getBits(){
+  return _bits;
+}
+
+void FadeLedBamBase::flush(byte first, byte last){
+  //the interrupt may not take the table while it's build
+  __atomic_store_n(&_ready, (byte)false, __ATOMIC_SEQ_CST);
+  //and one that's taking it now must be done, then the other table is released
+  while(__atomic_load_n(&_swapping, __ATOMIC_SEQ_CST)){
+  }
+  FadeLedBamPort* planes = _planes + (__atomic_load_n(&_active, __ATOMIC_ACQUIRE) ^ 1) * _bits * _maxPorts;
+
+  for(unsigned int i = 0; i < (unsigned int)_bits * _maxPorts; i++){
+    planes[i] = 0;
+  }
+  for(byte ch = 0; ch < _channels; ch++){
+    unsigned int level = scale(_frame[ch]);
+    FadeLedBamPort* plane = planes + _chanPort[ch];
+    FadeLedBamPort mask = _chanMask[ch];
+    //one set bit at a time, stop at the last
+    while(level){
+      if(level & 1){
+        *plane |= mask;
+      }
+      level >>= 1;
+      plane += _maxPorts;
+    }
+  }
+
+  __atomic_store_n(&_ready, (byte)true, __ATOMIC_RELEASE);
+}
+
+unsigned int FadeLedBamBase::scale(flvar_t level){
+  if(_bits <= FADE_LED_PWM_BITS){
+    return level >> (FADE_LED_PWM_BITS - _bits);
+  }
+  //repeat the top bits so full on stays full on
+  byte shift = _bits - FADE_LED_PWM_BITS;
+  return ((unsigned int)level << shift) | (level >> (FADE_LED_PWM_BITS - shift));
+}
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ *  @file FadeLedBam.h
+ *  @brief Software PWM (bit angle modulation) on ordinary pins.
+ *
+ *  @details analogWrite() only works on the hardware PWM pins, 6 on an Uno. A FadeLedBam is an output backend that drives any digital pin with bit angle modulation from a timer interrupt. Each bit of the level gets its own time slot, twice as long as the slot of the bit below. For each slot a table holds what to write to each port, so the interrupt only writes a few port registers. Needs portOutputRegister() of the core (AVR, SAMD, ESP and most others).
+ */
+
+#ifndef _FADE_LED_BAM_H
+#define _FADE_LED_BAM_H
+
+#include "FadeLed.h"
+
+#if defined(portOutputRegister) || defined(DOXYGEN)
+
+#if defined(__AVR__)
+typedef uint8_t FadeLedBamPort; //!< Width of a port register
+#else
+typedef uint32_t FadeLedBamPort; //!< Width of a port register
+#endif
+
+/**
+ *  @brief Shared part of all FadeLedBam's
+ *
+ *  @details Does all the work, FadeLedBam only supplies the buffers. Use FadeLedBam to make one.
+ *
+ *  @see FadeLedBam
+ */
+class FadeLedBamBase : public FadeLedOutput{
+  public:
+    /**
+     *  @brief Sets up the pins
+     *
+     *  @details Makes all pins an output (LOW) and looks up their port. Call it in setup() before the timer starts.
+     *
+     *  @return false if the pins are on more ports than the FadeLedBam has room for, nothing is driven then
+     */
+    bool begin();
+
+    /**
+     *  @brief Writes the next bit plane to the pins
+     *
+     *  @details Call it from a timer interrupt. The interrupt must come back after the returned number of units (the time of the shortest slot). So setting the compare value of the timer to the returned value times the unit in timer counts gives a full cycle every 2^Bits - 1 units. For example with an unit of 12us, 8 bits gives a cycle of 3ms, 327Hz.
+     *
+     *  A new frame (from FadeLed::update()) is picked up at the start of a cycle so a cycle never mixes two frames.
+     *
+     *  @return Units till the next call
+     */
+    unsigned int isr();
+
+    /**
+     *  @brief Returns the number of bits (slots) per cycle
+     */
+    byte getBits();
+
+  protected:
+    /**
+     *  @brief Constructor, used by FadeLedBam
+     *
+     *  @param [in] frame    Frame buffer of channels levels
+     *  @param [in] channels Number of channels
+     *  @param [in] pins     Pin of each channel
+     *  @param [in] chanPort Buffer of channels bytes for the port index of each channel
+     *  @param [in] chanMask Buffer of channels masks for the bit of each channel
+     *  @param [in] regs     Buffer of ports port registers
+     *  @param [in] masks    Buffer of ports masks of the pins used in each port
+     *  @param [in] planes   Buffer of 2 * bits * ports bit planes
+     *  @param [in] ports    Max number of ports
+     *  @param [in] bits     Number of bits
+     */
+    FadeLedBamBase(flvar_t* frame, byte channels, byte* pins, byte* chanPort, FadeLedBamPort* chanMask,
+                   volatile FadeLedBamPort** regs, FadeLedBamPort* masks, FadeLedBamPort* planes, byte ports, byte bits);
+
+    /**
+     *  @brief Builds the bit planes of all channels in the table the interrupt doesn't use
+     *
+     *  @details It can't only do channels first to last, that table is a frame behind.
+     */
+    void flush(byte first, byte last);
+
+    /**
+     *  @brief Scales a level of #FADE_LED_PWM_BITS to #_bits
+     */
+    unsigned int scale(flvar_t level);
+
+    byte* const _pins; //!< Pin of each channel
+    byte* const _chanPort; //!< Port index of each channel
+    FadeLedBamPort* const _chanMask; //!< Bit of each channel in its port
+    volatile FadeLedBamPort** const _regs; //!< Output register of each port
+    FadeLedBamPort* const _masks; //!< Pins used of each port
+    FadeLedBamPort* const _planes; //!< Two tables of #_bits planes of #_maxPorts ports
+    const byte _maxPorts; //!< Room for ports
+    const byte _bits; //!< Number of bits
+    byte _ports; //!< Ports used, 0 before begin()
+    byte _bit; //!< Bit (slot) the interrupt writes next
+    byte _active; //!< Table the interrupt uses
+    byte _ready; //!< The other table holds a new frame
+    byte _swapping; //!< isr() is taking the other table, flush() waits till it's done
+};
+
+/**
+ *  @brief Output backend that drives ordinary pins with software PWM
+ *
+ *  @details The channels are the pins given in the constructor, in that order. A FadeLed object writes to it with FadeLed::setOutput(), its pin is the channel.
+ *
+ *  ```C++
+ *  const byte Pins[] = {2, 3, 4, 5, 6, 7, 8, 12};
+ *  FadeLedBam<8> bam(Pins);
+ *  FadeLed led(0); //channel 0, so pin 2
+ *
+ *  ISR(TIMER1_COMPA_vect){
+ *    OCR1A = bam.isr() * 24 - 1; //unit of 24 counts
+ *  }
+ *
+ *  void setup(){
+ *    bam.begin();
+ *    led.setOutput(&bam);
+ *    //start Timer1 in CTC mode, see the SoftPwm example
+ *  }
+ *  ```
+ *
+ *  The interrupt does a read-modify-write of each port. Other pins on those ports are left alone, but code that writes them outside the interrupt must do it with interrupts off (digitalWrite() does).
+ *
+ *  RAM: channels * (2 + port width) + ports * (2 * Bits + 1) * port width + a pointer per port. A port is 1 byte on AVR, 4 bytes on the others.
+ *
+ *  @tparam Channels Number of channels (pins), max 255
+ *  @tparam Ports    Max number of ports the pins are on
+ *  @tparam Bits     Bits of software PWM (1 to 16). More bits is finer but with the same unit a slower cycle.
+ */
+template <byte Channels, byte Ports = 4, byte Bits = 8>
+class FadeLedBam : public FadeLedBamBase{
+  public:
+    /**
+     *  @brief Constructor
+     *
+     *  @details Nothing is driven before begin().
+     *
+     *  @param [in] pins The pin of each channel
+     */
+    FadeLedBam(const byte (&pins)[Channels]) :
+      FadeLedBamBase(_levels, Channels, _pinList, _chanPortList, _chanMaskList, _regList, _maskList, _planeList, Ports, Bits)
+    {
+      for(byte i = 0; i < Channels; i++){
+        _pinList[i] = pins[i];
+      }
+    }
+
+  protected:
+    flvar_t _levels[Channels]; //!< Frame buffer
+    byte _pinList[Channels]; //!< Pin of each channel
+    byte _chanPortList[Channels]; //!< Port index of each channel
+    FadeLedBamPort _chanMaskList[Channels]; //!< Bit of each channel
+    volatile FadeLedBamPort* _regList[Ports]; //!< Output register of each port
+    FadeLedBamPort _maskList[Ports]; //!< Pins used of each port
+    FadeLedBamPort _planeList[2 * Bits * Ports]; //!< Two tables of bit planes
+};
+
+#endif
+
+#endif
@@ -0,0 +1,161 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+#include "FadeLedCore.h"
+
+FadeLedCoreBase::List* FadeLedCoreBase::_lists = nullptr;
+
+FadeLedCoreBase::FadeLedCoreBase(byte pin, flvar_t biggestStep, List& list) :
+  _pin(pin),
+  _biggestStep(biggestStep),
+  _setVal(0),
+  _startVal(0),
+  _curVal(0),
+  _constTime(false),
+  _fading(false),
+  _countMax(40),
+  _count(0),
+  #if FADE_LED_ELAPSED_TIME
+  _startTick(0),
+  #endif
+  _step(),
+  _output(nullptr),
+  _list(list),
+  _nextCore(list.first)
+{
+  list.first = this;
+  //first of its kind
+  if(!list.linked){
+    list.next = _lists;
+    list.linked = true;
+    _lists = &list;
+  }
+  FadeLed::_hooks[FadeLed::HookCore] = updateAll;
+}
+
+FadeLedCoreBase::~FadeLedCoreBase(){
+  FadeLedCoreBase** link = &_list.first;
+  while(*link && *link != this){
+    link = &(*link)->_nextCore;
+  }
+  if(*link){
+    *link = _nextCore;
+  }
+}
+
+void FadeLedCoreBase::set(flvar_t val){
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may not see it halfway
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    if(_setVal == val){
+      return;
+    }
+    if(val > _biggestStep){
+      val = _biggestStep;
+    }
+
+    //same rules as FadeLed::setNow()
+    if(_curVal != _setVal){
+      if(_constTime){
+        return;
+      }
+      else if(( (_startVal < _setVal) && (_curVal < val)) || //up
+              ( (_startVal > _setVal) && (_curVal > val)) ){ //down
+        _setVal = val;
+        return;
+      }
+    }
+
+    _setVal = val;
+    _count = 1;
+    #if FADE_LED_ELAPSED_TIME
+    _startTick = FadeLed::currentTick();
+    #endif
+    _startVal = _curVal;
+    setupStep();
+    _fading = (_curVal != _setVal);
+  }
+}
+
+void FadeLedCoreBase::on(){
+  set(_biggestStep);
+}
+
+void FadeLedCoreBase::off(){
+  set(0);
+}
+
+void FadeLedCoreBase::stop(){
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    _setVal = _curVal;
+  }
+}
+
+void FadeLedCoreBase::setTime(unsigned long time, bool constTime){
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    unsigned long count = time / FadeLed::getInterval();
+    #if FADE_LED_MAX_INTERVALS < 4294967294UL
+    if(count > FADE_LED_MAX_INTERVALS){
+      count = FADE_LED_MAX_INTERVALS;
+    }
+    #endif
+    _countMax = count;
+    _constTime = constTime;
+
+    //continue the current fade with the new time
+    if(_curVal != _setVal){
+      setupStep();
+    }
+  }
+}
+
+bool FadeLedCoreBase::done(){
+  return _curVal == _setVal;
+}
+
+flvar_t FadeLedCoreBase::get(){
+  return _setVal;
+}
+
+flvar_t FadeLedCoreBase::getCurrent(){
+  return _curVal;
+}
+
+bool FadeLedCoreBase::rising(){
+  return _curVal < _setVal;
+}
+
+bool FadeLedCoreBase::falling(){
+  return _curVal > _setVal;
+}
+
+flvar_t FadeLedCoreBase::getBiggestStep(){
+  return _biggestStep;
+}
+
+void FadeLedCoreBase::setOutput(FadeLedOutput* output){
+  _output = output;
+}
+
+void FadeLedCoreBase::setupStep(){
+  //same distance as FadeLed::setupStep()
+  flvar_t dist = _biggestStep;
+  if(_constTime){
+    dist = (_setVal > _startVal) ? (_setVal - _startVal) : (_startVal - _setVal);
+  }
+
+  _step.setup(_count, dist, _countMax);
+}
+
+void FadeLedCoreBase::updateAll(){
+  for(List* list = _lists; list; list = list->next){
+    list->update();
+  }
+}
@@ -0,0 +1,368 @@
+/**
+ *  @file FadeLedCore.h
+ *  @brief Fading with the output width, steps and gamma correction fixed at compile time.
+ *
+ *  @details A FadeLed object takes its gamma table, biggest step and output width at runtime and from #FADE_LED_PWM_BITS, so every output write checks if there is a table and if it's compressed. A FadeLedCore gets them as template parameters. The compiler then makes the write path for exactly that table, without any check. And objects with a different output width can be used next to each other, like 8-bit pins and a 12-bit PWM driver in a build with #FADE_LED_PWM_BITS 12.
+ */
+
+#ifndef _FADE_LED_CORE_H
+#define _FADE_LED_CORE_H
+
+#include "FadeLed.h"
+
+/**
+ *  @brief Gamma policy without gamma correction
+ *
+ *  @details The steps are spread evenly over the output levels. With as many steps as output levels the step is the output level.
+ */
+struct FadeLedPolicyLinear{
+  /**
+   *  @brief The curve for an output width and number of steps
+   */
+  template <byte Bits, unsigned long Steps>
+  struct Curve{
+    static constexpr flvar_t BiggestStep = Steps - 1; //!< Biggest step
+
+    /**
+     *  @brief Output level of a step
+     */
+    static flvar_t read(flvar_t step){
+      //decided by the compiler, only one of them is left
+      return (Steps == (1UL << Bits)) ? step : (flvar_t)(((unsigned long)step * Scale) >> 16);
+    }
+
+  private:
+    //output levels per step in Q16, rounded up so the biggest step gives exactly the biggest level
+    static constexpr unsigned long Scale = ((((1UL << Bits) - 1) << 16) + (Steps - 2)) / (Steps - 1);
+  };
+};
+
+/**
+ *  @brief Gamma policy with a full gamma table
+ *
+ *  @details The table is a FadeLedGammaCurve, made at compile time. FadeLedPolicyGamma<2300> with 101 steps is the same as the default gamma table of FadeLed.
+ *
+ *  @tparam Gamma1000 The gamma times 1000, so 2300 for a gamma of 2.3
+ */
+template <unsigned int Gamma1000>
+struct FadeLedPolicyGamma{
+  /**
+   *  @brief The curve for an output width and number of steps
+   */
+  template <byte Bits, unsigned long Steps>
+  struct Curve{
+    typedef FadeLedGammaCurve<Gamma1000, Steps, Bits> Table; //!< The table in PROGMEM
+    static constexpr flvar_t BiggestStep = Steps - 1; //!< Biggest step
+
+    /**
+     *  @brief Output level of a step
+     */
+    static flvar_t read(flvar_t step){
+      return FadeLedGammaReadLevel(Table::table + step);
+    }
+  };
+};
+
+/**
+ *  @brief Gamma policy with a compressed (piecewise linear) gamma table
+ *
+ *  @details The table is a FadeLedGammaPwlCurve, made at compile time. Same interpolation as FadeLedGammaRead() but with the segment size known to the compiler.
+ *
+ *  @tparam Gamma1000 The gamma times 1000, so 2300 for a gamma of 2.3
+ *  @tparam SegBits   A knot every 2^SegBits steps, Steps - 1 must be a multiple of it
+ */
+template <unsigned int Gamma1000, byte SegBits>
+struct FadeLedPolicyPwl{
+  /**
+   *  @brief The curve for an output width and number of steps
+   */
+  template <byte Bits, unsigned long Steps>
+  struct Curve{
+    typedef FadeLedGammaPwlCurve<Gamma1000, Steps, SegBits, Bits> Table; //!< The knots in PROGMEM
+    static constexpr flvar_t BiggestStep = Steps - 1; //!< Biggest step
+
+    /**
+     *  @brief Output level of a step
+     */
+    static flvar_t read(flvar_t step){
+      const flvar_t* knot = Table::table + (step >> SegBits);
+      flvar_t frac = step & ((1U << SegBits) - 1);
+      flvar_t level = FadeLedGammaReadLevel(knot);
+      if(frac){
+        flvar_t slope = FadeLedGammaReadLevel(knot + 1) - level;
+        level += ((unsigned long)slope * frac + (1UL << (SegBits - 1))) >> SegBits;
+      }
+      return level;
+    }
+  };
+};
+
+/**
+ *  @brief Shared part of all FadeLedCore's
+ *
+ *  @details Holds the fade and does everything that doesn't write the output. Use FadeLedCore to make one.
+ *
+ *  @see FadeLedCore
+ */
+class FadeLedCoreBase{
+  public:
+    /**
+     *  @brief Set the brightness to fade to
+     *
+     *  @details Same as FadeLed::set(): in constant fade time a new brightness while fading is ignored, in constant fade speed it continues to the new brightness if that's in the same direction.
+     *
+     *  @param [in] val The brightness to fade to, limited to getBiggestStep()
+     */
+    void set(flvar_t val);
+
+    /**
+     *  @brief Fade to full on
+     */
+    void on();
+
+    /**
+     *  @brief Fade to off
+     */
+    void off();
+
+    /**
+     *  @brief Stops the current fade at the current brightness
+     */
+    void stop();
+
+    /**
+     *  @brief Set the time a fade takes
+     *
+     *  @details Same as FadeLed::setTime().
+     *
+     *  @param [in] time      The time (ms) a fade takes
+     *  @param [in] constTime **true** for constant fade time, **false** (default) for constant fade speed (time of a fade over the full range)
+     */
+    void setTime(unsigned long time, bool constTime = false);
+
+    /**
+     *  @brief Returns if it's done fading
+     */
+    bool done();
+
+    /**
+     *  @brief Returns the brightness it fades to (or is at)
+     */
+    flvar_t get();
+
+    /**
+     *  @brief Returns the current brightness
+     */
+    flvar_t getCurrent();
+
+    /**
+     *  @brief Returns if it's fading up
+     */
+    bool rising();
+
+    /**
+     *  @brief Returns if it's fading down
+     */
+    bool falling();
+
+    /**
+     *  @brief Get the biggest brightness step
+     */
+    flvar_t getBiggestStep();
+
+    /**
+     *  @brief Write to an output backend
+     *
+     *  @details Like FadeLed::setOutput(), the pin is the channel of the output. The output gets levels of the width of this object.
+     *
+     *  @param [in] output The output to write to, nullptr to use analogWrite()
+     */
+    void setOutput(FadeLedOutput* output);
+
+    /**
+     *  @brief Updates all FadeLedCore's
+     *
+     *  @details Called by FadeLed::update() each interval once the first FadeLedCore is made, you don't need to call it yourself. Calls the update of each kind of FadeLedCore.
+     */
+    static void updateAll();
+
+  protected:
+    /**
+     *  @brief All objects of one kind of FadeLedCore and how to update them
+     */
+    struct List{
+      FadeLedCoreBase* first; //!< First object of this kind
+      void (*const update)(); //!< Updates all objects of this kind
+      List* next; //!< Next kind in #_lists
+      bool linked; //!< In #_lists
+    };
+
+    /**
+     *  @brief Constructor, links it in the list of its kind
+     *
+     *  @param [in] pin         The PWM pin (or output channel)
+     *  @param [in] biggestStep The biggest step of the curve
+     *  @param [in] list        The list of its kind, linked in the kinds updateAll() updates if it isn't yet
+     */
+    FadeLedCoreBase(byte pin, flvar_t biggestStep, List& list);
+
+    /**
+     *  @brief Destructor, removes it from the list of its kind
+     */
+    ~FadeLedCoreBase();
+
+    /**
+     *  @brief Sets the stepping up for the current fade, same as FadeLed::setupStep()
+     */
+    void setupStep();
+
+    /**
+     *  @brief Steps the fade one interval
+     *
+     *  @details Same steps as FadeLed::updateThis(), the caller writes the output.
+     *
+     *  @return **true** if the brightness changed
+     */
+    bool step();
+
+    const byte _pin; //!< PWM pin (or output channel)
+    const flvar_t _biggestStep; //!< Biggest step of the curve, only used outside the write path
+    flvar_t _setVal; //!< Brightness it fades to
+    flvar_t _startVal; //!< Brightness the fade started at
+    flvar_t _curVal; //!< Current brightness
+    bool _constTime; //!< Constant time fade or just constant speed fade
+    bool _fading; //!< A fade is in progress
+    flcount_t _countMax; //!< The number of intervals a fade should take
+    flcount_t _count; //!< The number of intervals passed
+    #if FADE_LED_ELAPSED_TIME
+    unsigned long _startTick; //!< FadeLed tick at which the fade started
+    #endif
+    FadeLedStep<flvar_t> _step; //!< Steps faded at #_count and what to add each interval
+    FadeLedOutput* _output; //!< Output backend, nullptr for analogWrite()
+    List& _list; //!< The list of its kind
+    FadeLedCoreBase* _nextCore; //!< Next of the same kind
+
+    static List* _lists; //!< First kind of FadeLedCore
+};
+
+/**
+ *  @brief A LED with the output width, steps and gamma correction fixed at compile time
+ *
+ *  @details Fades exactly like a FadeLed object with the same table (constant fade time and constant fade speed, incremental engine), but the stepping and output write are made for the curve by the compiler, each kind of FadeLedCore is updated by its own loop. Has no dithering, easing, retargeting or completed(). Updated by FadeLed::update() like a FadeLed object. With #FADE_LED_ISR on another platform than AVR, only change it when the timer interrupt can't run.
+ *
+ *  ```C++
+ *  //8-bit pin with the default gamma curve, next to a 12-bit PCA9685 channel with 4097 steps in a compressed table
+ *  FadeLedCore<8> led(5);
+ *  FadeLedCore<12, 4097, FadeLedPolicyPwl<2300, 6> > strip(0);
+ *
+ *  void setup(){
+ *    strip.setOutput(&pca9685);
+ *  }
+ *  ```
+ *
+ *  @tparam Bits   Width of the output levels, max #FADE_LED_PWM_BITS
+ *  @tparam Steps  Number of steps, so the biggest step is Steps - 1. **Default** 101 (0 to 100)
+ *  @tparam Gamma  FadeLedPolicyLinear, FadeLedPolicyGamma or FadeLedPolicyPwl. **Default** a full table with gamma 2.3
+ */
+template <byte Bits = FADE_LED_PWM_BITS, unsigned long Steps = 101, class Gamma = FadeLedPolicyGamma<2300> >
+class FadeLedCore : public FadeLedCoreBase{
+  static_assert(Bits <= FADE_LED_PWM_BITS, "More bits than FADE_LED_PWM_BITS");
+  static_assert(Steps >= 2 && Steps - 1 <= (flvar_t)~0, "Steps don't fit flvar_t");
+
+  public:
+    typedef typename Gamma::template Curve<Bits, Steps> Curve; //!< The curve of the policy
+    static constexpr flvar_t BiggestStep = Steps - 1; //!< Biggest step
+
+    /**
+     *  @brief Constructor
+     *
+     *  @details Starts at brightness 0 in constant fade speed with a fade time of 2 seconds (at an interval of 50ms).
+     *
+     *  @param [in] pin The PWM pin (or output channel)
+     */
+    FadeLedCore(byte pin) : FadeLedCoreBase(pin, BiggestStep, _cores){
+
+    }
+
+    /**
+     *  @brief Set the brightness directly, without fading
+     *
+     *  @param [in] val The brightness, limited to #BiggestStep
+     */
+    void begin(flvar_t val){
+      #if FADE_LED_ISR && defined(__AVR__)
+      //tick() may not see it halfway
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      #endif
+      {
+        if(val > BiggestStep){
+          val = BiggestStep;
+        }
+        _setVal = val;
+        _curVal = val;
+        _fading = false;
+        FadeLed::writeOutput(_output, _pin, Curve::read(val));
+      }
+    }
+
+    /**
+     *  @brief Set to full on directly, without fading
+     */
+    void beginOn(){
+      begin(BiggestStep);
+    }
+
+  private:
+    /**
+     *  @brief Updates all objects of this kind, with the curve known to the compiler
+     */
+    static void updateCores(){
+      //only objects of this kind are in the list
+      for(FadeLedCore* core = static_cast<FadeLedCore*>(_cores.first); core; core = static_cast<FadeLedCore*>(core->_nextCore)){
+        if(core->step()){
+          FadeLed::writeOutput(core->_output, core->_pin, Curve::read(core->_curVal));
+        }
+      }
+    }
+
+    static List _cores; //!< All objects of this kind
+};
+
+template <byte Bits, unsigned long Steps, class Gamma>
+FadeLedCoreBase::List FadeLedCore<Bits, Steps, Gamma>::_cores = {nullptr, FadeLedCore<Bits, Steps, Gamma>::updateCores, nullptr, false};
+
+inline bool FadeLedCoreBase::step(){
+  if(!_fading){
+    return false;
+  }
+  //stopped or set back to where it is
+  if(_curVal == _setVal){
+    _fading = false;
+    return false;
+  }
+
+  #if FADE_LED_ELAPSED_TIME
+  //jump to the intervals passed since the fade started
+  unsigned long count = FadeLed::_tick - _startTick;
+  if(count > _countMax){
+    count = _countMax;
+  }
+  if(count != _count){
+    _count = count;
+    setupStep();
+  }
+  #endif
+
+  flvar_t newVal = FadeLedStepTo(_startVal, _setVal, _step.pos);
+  bool changed = (newVal != _curVal);
+  _curVal = newVal;
+  _count++;
+  _step.next(_countMax);
+
+  if(_curVal == _setVal){
+    _fading = false;
+  }
+  return changed;
+}
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ *  @file FadeLedEasing.h
+ *  @brief Easing curves to shape a fade.
+ *
+ *  @details An easing curve changes how a fade moves over time (like slow at the start and fast at the end) without touching the gamma table. Set one with FadeLed::setEasing() or FadeLedGroupBase::setEasing(). The tables are made with `extras/EasingTable.py`, that script can also make a table of your own curve.
+ */
+
+#ifndef _FADE_LED_EASING_H
+#define _FADE_LED_EASING_H
+
+const uint16_t* const FadeLedEaseLinear = nullptr; //!< No easing, a linear fade
+
+const byte FadeLedEasingSize = 33; //!< Number of values in an easing table
+const byte FadeLedEasingShift = 10; //!< 1/32768 progress to segment of the table
+
+/* Easing: quadratic ease in (t^2) */
+const uint16_t FadeLedEaseInQuad[FadeLedEasingSize] PROGMEM = {
+	    0,    32,   128,   288,   512,   800,  1152,  1568,  2048,  2592,  3200,
+	 3872,  4608,  5408,  6272,  7200,  8192,  9248, 10368, 11552, 12800, 14112,
+	15488, 16928, 18432, 20000, 21632, 23328, 25088, 26912, 28800, 30752, 32768
+};
+
+/* Easing: quadratic ease out */
+const uint16_t FadeLedEaseOutQuad[FadeLedEasingSize] PROGMEM = {
+	    0,  2016,  3968,  5856,  7680,  9440, 11136, 12768, 14336, 15840, 17280,
+	18656, 19968, 21216, 22400, 23520, 24576, 25568, 26496, 27360, 28160, 28896,
+	29568, 30176, 30720, 31200, 31616, 31968, 32256, 32480, 32640, 32736, 32768
+};
+
+/* Easing: quadratic ease in and out */
+const uint16_t FadeLedEaseInOutQuad[FadeLedEasingSize] PROGMEM = {
+	    0,    64,   256,   576,  1024,  1600,  2304,  3136,  4096,  5184,  6400,
+	 7744,  9216, 10816, 12544, 14400, 16384, 18368, 20224, 21952, 23552, 25024,
+	26368, 27584, 28672, 29632, 30464, 31168, 31744, 32192, 32512, 32704, 32768
+};
+
+/* Easing: cubic ease in (t^3) */
+const uint16_t FadeLedEaseInCubic[FadeLedEasingSize] PROGMEM = {
+	    0,     1,     8,    27,    64,   125,   216,   343,   512,   729,  1000,
+	 1331,  1728,  2197,  2744,  3375,  4096,  4913,  5832,  6859,  8000,  9261,
+	10648, 12167, 13824, 15625, 17576, 19683, 21952, 24389, 27000, 29791, 32768
+};
+
+/* Easing: cubic ease out */
+const uint16_t FadeLedEaseOutCubic[FadeLedEasingSize] PROGMEM = {
+	    0,  2977,  5768,  8379, 10816, 13085, 15192, 17143, 18944, 20601, 22120,
+	23507, 24768, 25909, 26936, 27855, 28672, 29393, 30024, 30571, 31040, 31437,
+	31768, 32039, 32256, 32425, 32552, 32643, 32704, 32741, 32760, 32767, 32768
+};
+
+/* Easing: cubic ease in and out */
+const uint16_t FadeLedEaseInOutCubic[FadeLedEasingSize] PROGMEM = {
+	    0,     4,    32,   108,   256,   500,   864,  1372,  2048,  2916,  4000,
+	 5324,  6912,  8788, 10976, 13500, 16384, 19268, 21792, 23980, 25856, 27444,
+	28768, 29852, 30720, 31396, 31904, 32268, 32512, 32660, 32736, 32764, 32768
+};
+
+/* Easing: sine ease in (quarter of a cosine) */
+const uint16_t FadeLedEaseInSine[FadeLedEasingSize] PROGMEM = {
+	    0,    39,   158,   355,   630,   982,  1411,  1915,  2494,  3146,  3869,
+	 4662,  5522,  6448,  7438,  8489,  9598, 10762, 11980, 13248, 14563, 15922,
+	17321, 18758, 20228, 21729, 23256, 24806, 26375, 27960, 29556, 31160, 32768
+};
+
+/* Easing: sine ease out (quarter of a sine) */
+const uint16_t FadeLedEaseOutSine[FadeLedEasingSize] PROGMEM = {
+	    0,  1608,  3212,  4808,  6393,  7962,  9512, 11039, 12540, 14010, 15447,
+	16846, 18205, 19520, 20788, 22006, 23170, 24279, 25330, 26320, 27246, 28106,
+	28899, 29622, 30274, 30853, 31357, 31786, 32138, 32413, 32610, 32729, 32768
+};
+
+/* Easing: sine ease in and out (half a cosine) */
+const uint16_t FadeLedEaseInOutSine[FadeLedEasingSize] PROGMEM = {
+	    0,    79,   315,   705,  1247,  1935,  2761,  3719,  4799,  5990,  7282,
+	 8661, 10114, 11628, 13188, 14778, 16384, 17990, 19580, 21140, 22654, 24107,
+	25486, 26778, 27969, 29049, 30007, 30833, 31521, 32063, 32453, 32689, 32768
+};
+
+/* Easing: exponential ease in (2^(10t - 10)) */
+const uint16_t FadeLedEaseInExpo[FadeLedEasingSize] PROGMEM = {
+	    0,    40,    49,    61,    76,    95,   117,   146,   181,   225,   279,
+	  347,   431,   535,   664,   825,  1024,  1272,  1579,  1961,  2435,  3025,
+	 3756,  4664,  5793,  7194,  8933, 11094, 13777, 17109, 21247, 26386, 32768
+};
+
+/* Easing: exponential ease out */
+const uint16_t FadeLedEaseOutExpo[FadeLedEasingSize] PROGMEM = {
+	    0,  6382, 11521, 15659, 18991, 21674, 23835, 25574, 26975, 28104, 29012,
+	29743, 30333, 30807, 31189, 31496, 31744, 31943, 32104, 32233, 32337, 32421,
+	32489, 32543, 32587, 32622, 32651, 32673, 32692, 32707, 32719, 32728, 32768
+};
+
+/* Easing: exponential ease in and out */
+const uint16_t FadeLedEaseInOutExpo[FadeLedEasingSize] PROGMEM = {
+	    0,    25,    38,    59,    91,   140,   215,   332,   512,   790,  1218,
+	 1878,  2896,  4467,  6889, 10624, 16384, 22144, 25879, 28301, 29872, 30890,
+	31550, 31978, 32256, 32436, 32553, 32628, 32677, 32709, 32730, 32743, 32768
+};
+
+/**
+ *  @brief Reads the eased progress from an easing table in PROGMEM
+ *
+ *  @details The table has the eased progress at every 1/32 of the fade, the progress in between is interpolated with one multiply.
+ *
+ *  @param [in] easing   The easing table in PROGMEM, not nullptr
+ *  @param [in] progress Progress of the fade in 1/32768 (32768 is done)
+ *  @return The eased progress in 1/32768
+ */
+inline unsigned int FadeLedEasingRead(const uint16_t* easing, unsigned int progress){
+  const uint16_t* point = easing + (progress >> FadeLedEasingShift);
+  unsigned int frac = progress & ((1U << FadeLedEasingShift) - 1);
+  unsigned int eased = pgm_read_word_near(point);
+  if(frac){
+    long slope = (long)pgm_read_word_near(point + 1) - (long)eased;
+    eased += (slope * (long)frac) >> FadeLedEasingShift;
+  }
+  return eased;
+}
+
+/**
+ *  @brief Reads the slope of an easing table in PROGMEM
+ *
+ *  @details The slope of the segment of the table the progress is in.
+ *
+ *  @param [in] easing   The easing table in PROGMEM, not nullptr
+ *  @param [in] progress Progress of the fade in 1/32768 (32768 is done)
+ *  @return Eased progress per progress in 1/1024, 1024 is the speed of a linear fade
+ */
+inline long FadeLedEasingSlope(const uint16_t* easing, unsigned int progress){
+  unsigned int segment = progress >> FadeLedEasingShift;
+  if(segment > FadeLedEasingSize - 2){
+    segment = FadeLedEasingSize - 2;
+  }
+  return (long)pgm_read_word_near(easing + segment + 1) - (long)pgm_read_word_near(easing + segment);
+}
+
+#endif
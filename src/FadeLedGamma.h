@@ -169,4 +169,45 @@ const flvar_t FadeLedGammaTable16[101] PROGMEM = {
   #error PWM resolution not supported for Gamma correction
 #endif
 
+/**
+ *  @brief Reads one level of a gamma table in PROGMEM
+ */
+inline flvar_t FadeLedGammaReadLevel(const flvar_t* level){
+  #if FADE_LED_PWM_BITS <= 8
+    return pgm_read_byte_near(level);
+  #else
+    return pgm_read_word_near(level);
+  #endif
+}
+
+/**
+ *  @brief Reads the output level for a step from a gamma table in PROGMEM
+ *
+ *  @details With segmentBits 0 the table is a full table with a level for each step. Otherwise the table is compressed (piecewise linear), it only has a level (knot) every 2^segmentBits steps. The steps in between are interpolated between the two knots around them with one multiply.
+ *
+ *  @param [in] table       The gamma table in PROGMEM, nullptr for no gamma correction
+ *  @param [in] segmentBits 0 for a full table, otherwise there is a knot every 2^segmentBits steps
+ *  @param [in] step        The step to get the level for, not checked for range
+ *  @return The output level for step
+ */
+inline flvar_t FadeLedGammaRead(const flvar_t* table, byte segmentBits, flvar_t step){
+  if(table == nullptr){
+    return step;
+  }
+
+  if(segmentBits == 0){
+    return FadeLedGammaReadLevel(table + step);
+  }
+
+  //knot before step and how far step is into the segment
+  const flvar_t* knot = table + (step >> segmentBits);
+  flvar_t frac = step & ((1U << segmentBits) - 1);
+  flvar_t level = FadeLedGammaReadLevel(knot);
+  if(frac){
+    flvar_t slope = FadeLedGammaReadLevel(knot + 1) - level;
+    level += ((unsigned long)slope * frac + (1UL << (segmentBits - 1))) >> segmentBits;
+  }
+  return level;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,230 @@
+/**
+ *  @file FadeLedGammaCurve.h
+ *  @brief Gamma tables generated at compile time.
+ *
+ *  @details FadeLedGammaCurve makes the same gamma table as `extras/GammaTable.py` but by the compiler. So a custom curve is just a type, no need to run the script and paste the table. Only the tables that are used end up in flash.
+ */
+
+#ifndef _FADE_LED_GAMMA_CURVE_H
+#define _FADE_LED_GAMMA_CURVE_H
+
+/**
+ *  @brief constexpr math used by FadeLedGammaCurve
+ *
+ *  @details Written as single return recursive functions to be constexpr in C++11.
+ */
+namespace FadeLedGammaMath{
+  constexpr double Ln2 = 0.69314718055994530942;
+
+  //2 * (z + z^3/3 + z^5/5 + ...) = ln((1 + z) / (1 - z))
+  constexpr double lnSeries(double z2, double term, unsigned int n){
+    return (n > 61) ? 0.0 : term / n + lnSeries(z2, term * z2, n + 2);
+  }
+
+  //ln(m) for m in [1, 2)
+  constexpr double lnMantissa(double z){
+    return 2.0 * lnSeries(z * z, z, 1);
+  }
+
+  /**
+   *  @brief Natural logarithm of x >= 1
+   */
+  constexpr double ln(double x, int k = 0){
+    return (x >= 2.0) ? ln(x / 2.0, k + 1) : k * Ln2 + lnMantissa((x - 1.0) / (x + 1.0));
+  }
+
+  //1 + r + r^2/2! + ...
+  constexpr double expSeries(double r, double term, unsigned int n){
+    return (n > 25) ? term : term + expSeries(r, term * r / n, n + 1);
+  }
+
+  constexpr double scale(double v, int k){
+    return (k == 0) ? v : scale(v * 0.5, k + 1);
+  }
+
+  //e^y as e^r * 2^k with r in [0, ln 2)
+  constexpr double expReduced(double y, int k){
+    return scale(expSeries(y - k * Ln2, 1.0, 1), k);
+  }
+
+  /**
+   *  @brief e^y for y <= 0
+   *
+   *  @details Everything below e^-60 is 0, that's far below half a step of any PWM width.
+   */
+  constexpr double expNeg(double y){
+    return (y < -60.0) ? 0.0 : expReduced(y, (int)(y / Ln2) - 1);
+  }
+
+  constexpr double power(double x, unsigned int n){
+    return (n == 0) ? 1.0 : x * power(x, n - 1);
+  }
+
+  /**
+   *  @brief (x / max) ^ gamma, like the normalized list of the script
+   *
+   *  @details The whole part of gamma is done by multiplying so a whole gamma gives exact ties, like the script.
+   */
+  constexpr double ratio(unsigned long x, unsigned long max, double gamma){
+    return (x == 0) ? 0.0
+      : (x >= max) ? 1.0
+      : (gamma == (unsigned int)gamma) ? power(x, (unsigned int)gamma) / power(max, (unsigned int)gamma)
+      : power(x, (unsigned int)gamma) / power(max, (unsigned int)gamma) * expNeg((gamma - (unsigned int)gamma) * (ln(x) - ln(max)));
+  }
+
+  //Python round(), ties go to the even value
+  constexpr unsigned long roundEven(double v, unsigned long f){
+    return (v - f > 0.5) ? f + 1 : (v - f < 0.5) ? f : f + (f & 1);
+  }
+
+  constexpr unsigned long roundLimit(double v, unsigned long top){
+    return (roundEven(v, (unsigned long)v) > top) ? top : roundEven(v, (unsigned long)v);
+  }
+
+  /**
+   *  @brief Output level of index i in a table of n steps, like rounder() of the script
+   */
+  constexpr unsigned long level(unsigned long i, unsigned long n, double gamma, unsigned long top){
+    return roundLimit(top * ratio(i, n - 1, gamma), top);
+  }
+
+  //Number of zero levels starting at index i, like countZero() of the script
+  constexpr unsigned long countZero(unsigned long i, unsigned long n, double gamma, unsigned long top){
+    return (i < n && level(i, n, gamma, top) == 0) ? 1 + countZero(i + 1, n, gamma, top) : 0;
+  }
+
+  /**
+   *  @brief Number of leading levels to skip so only the first level is 0
+   *
+   *  @details Same loop as the script: as long as more than one level is 0 make the table longer by the extra zeros and skip them.
+   */
+  constexpr unsigned long leadingZero(unsigned long steps, double gamma, unsigned long top, unsigned long skip = 0){
+    return (countZero(skip, steps + skip, gamma, top) > 1)
+      ? leadingZero(steps, gamma, top, skip + countZero(skip, steps + skip, gamma, top) - 1)
+      : skip;
+  }
+
+  template <unsigned int... I>
+  struct Indices{};
+
+  //Makes Indices<0, 1, ..., N - 1> with a recursion depth of log2(N)
+  template <class A, class B>
+  struct Join;
+
+  template <unsigned int... A, unsigned int... B>
+  struct Join<Indices<A...>, Indices<B...> >{
+    typedef Indices<A..., (sizeof...(A) + B)...> type;
+  };
+
+  template <unsigned int N>
+  struct MakeIndices{
+    typedef typename Join<typename MakeIndices<N / 2>::type, typename MakeIndices<N - N / 2>::type>::type type;
+  };
+
+  template <>
+  struct MakeIndices<0>{
+    typedef Indices<> type;
+  };
+
+  template <>
+  struct MakeIndices<1>{
+    typedef Indices<0> type;
+  };
+
+  template <unsigned int Gamma1000, byte Bits, class Seq>
+  struct Table;
+
+  template <unsigned int Gamma1000, byte Bits, unsigned int... I>
+  struct Table<Gamma1000, Bits, Indices<I...> >{
+    static constexpr unsigned long Top = (1UL << Bits) - 1;
+    static constexpr unsigned long Skip = leadingZero(sizeof...(I), Gamma1000 / 1000.0, Top);
+
+    static const flvar_t table[sizeof...(I)];
+  };
+
+  template <unsigned int Gamma1000, byte Bits, unsigned int... I>
+  const flvar_t Table<Gamma1000, Bits, Indices<I...> >::table[sizeof...(I)] PROGMEM = {
+    (flvar_t)level(I + Skip, sizeof...(I) + Skip, Gamma1000 / 1000.0, Top)...
+  };
+
+  template <unsigned int Gamma1000, unsigned int Steps, byte SegmentBits, byte Bits, class Seq>
+  struct PwlTable;
+
+  //Only the levels of every 2^SegmentBits step (the knots) of the full table
+  template <unsigned int Gamma1000, unsigned int Steps, byte SegmentBits, byte Bits, unsigned int... I>
+  struct PwlTable<Gamma1000, Steps, SegmentBits, Bits, Indices<I...> >{
+    static constexpr unsigned long Top = (1UL << Bits) - 1;
+    static constexpr unsigned long Skip = leadingZero(Steps, Gamma1000 / 1000.0, Top);
+
+    static const flvar_t table[sizeof...(I)];
+  };
+
+  template <unsigned int Gamma1000, unsigned int Steps, byte SegmentBits, byte Bits, unsigned int... I>
+  const flvar_t PwlTable<Gamma1000, Steps, SegmentBits, Bits, Indices<I...> >::table[sizeof...(I)] PROGMEM = {
+    (flvar_t)level(((unsigned long)I << SegmentBits) + Skip, Steps + Skip, Gamma1000 / 1000.0, Top)...
+  };
+}
+
+/**
+ *  @brief A gamma table made at compile time
+ *
+ *  @details Gives the same table as `extras/GammaTable.py` with the same parameters. Step 0 is always 0 and, if the PWM has enough levels, step 1 is the first level that's not 0. The table is placed in PROGMEM and only if it's used.
+ *
+ *  ```C++
+ *  //gamma 2.8, 64 steps for the PWM width of the library
+ *  typedef FadeLedGammaCurve<2800, 64> MyCurve;
+ *
+ *  led.setGammaTable(MyCurve::table, MyCurve::BiggestStep);
+ *  ```
+ *
+ *  @note The table is calculated with `double`. On AVR a double is only 32-bit so for more than 12-bit PWM a level can be one off compared to the script. The shipped tables (FadeLedGamma.h) are not affected.
+ *
+ *  @tparam Gamma1000 The gamma times 1000, so 2300 for a gamma of 2.3
+ *  @tparam Steps     Number of steps of the table, biggest step is Steps - 1
+ *  @tparam Bits      Number of PWM bits, max #FADE_LED_PWM_BITS
+ */
+template <unsigned int Gamma1000, unsigned int Steps, byte Bits = FADE_LED_PWM_BITS>
+class FadeLedGammaCurve : public FadeLedGammaMath::Table<Gamma1000, Bits, typename FadeLedGammaMath::MakeIndices<Steps>::type>{
+  static_assert(Steps >= 2, "A gamma table needs at least 2 steps");
+  static_assert(Bits <= FADE_LED_PWM_BITS, "More bits than FADE_LED_PWM_BITS");
+  static_assert(Steps - 1 <= (flvar_t)~0, "More steps than fit in flvar_t");
+  static_assert(Gamma1000 > 0, "Gamma must be bigger than 0");
+
+  public:
+    static constexpr flvar_t BiggestStep = Steps - 1; //!< Biggest step, use it for FadeLed::setGammaTable()
+};
+
+/**
+ *  @brief A compressed (piecewise linear) gamma table made at compile time
+ *
+ *  @details Same curve as FadeLedGammaCurve with the same parameters but only every 2^SegBits step (a knot) is stored. The steps in between are interpolated. Made for 12 to 16-bit PWM where a smooth fade needs thousands of steps. For example 4097 steps in 16-bit takes 8194 bytes as full table and 130 bytes with SegBits 6.
+ *
+ *  ```C++
+ *  //gamma 2.3 with 4097 steps (0 - 4096), a knot every 64 steps
+ *  typedef FadeLedGammaPwlCurve<2300, 4097, 6> MyCurve;
+ *
+ *  led.setGammaTable(MyCurve::table, MyCurve::BiggestStep, MyCurve::SegmentBits);
+ *  ```
+ *
+ *  @note Interpolating makes the low end less precise, a step can be a few levels off the full table there. See the host benchmark for the error of a curve.
+ *
+ *  @tparam Gamma1000   The gamma times 1000, so 2300 for a gamma of 2.3
+ *  @tparam Steps       Number of steps, Steps - 1 must be a multiple of 2^SegBits
+ *  @tparam SegBits     A knot every 2^SegBits steps
+ *  @tparam Bits        Number of PWM bits, max #FADE_LED_PWM_BITS
+ */
+template <unsigned int Gamma1000, unsigned int Steps, byte SegBits, byte Bits = FADE_LED_PWM_BITS>
+class FadeLedGammaPwlCurve : public FadeLedGammaMath::PwlTable<Gamma1000, Steps, SegBits, Bits,
+  typename FadeLedGammaMath::MakeIndices<((Steps - 1) >> SegBits) + 1>::type>{
+  static_assert(SegBits >= 1 && SegBits < FADE_LED_PWM_BITS, "SegBits out of range");
+  static_assert((Steps - 1) % (1UL << SegBits) == 0, "Steps - 1 must be a multiple of 2^SegBits");
+  static_assert(Bits <= FADE_LED_PWM_BITS, "More bits than FADE_LED_PWM_BITS");
+  static_assert(Steps - 1 <= (flvar_t)~0, "More steps than fit in flvar_t");
+  static_assert(Gamma1000 > 0, "Gamma must be bigger than 0");
+
+  public:
+    static constexpr flvar_t BiggestStep = Steps - 1; //!< Biggest step, use it for FadeLed::setGammaTable()
+    static constexpr byte SegmentBits = SegBits; //!< Segment size, use it for FadeLed::setGammaTable()
+};
+
+#endif
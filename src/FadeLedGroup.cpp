@@ -0,0 +1,138 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+#include "FadeLedGroup.h"
+
+FadeLedGroupBase* FadeLedGroupBase::_groupList = nullptr;
+
+FadeLedGroupBase::FadeLedGroupBase() :
+  _countMax(40),
+  _count(0),
+  #if FADE_LED_ELAPSED_TIME
+  _startTick(0),
+  #endif
+  _progress(),
+  _gammaLookup(FadeLedGammaTable),
+  #if FADE_LED_EASING
+  _easing(FadeLedEaseLinear),
+  #endif
+  _biggestStep(100),
+  _gammaSegmentBits(0),
+  _output(nullptr),
+  _fading(false),
+  _nextGroup(_groupList)
+{
+  _groupList = this;
+  FadeLed::_hooks[FadeLed::HookGroup] = updateAll;
+}
+
+FadeLedGroupBase::~FadeLedGroupBase(){
+  FadeLedGroupBase** link = &_groupList;
+  while(*link && *link != this){
+    link = &(*link)->_nextGroup;
+  }
+  if(*link){
+    *link = _nextGroup;
+  }
+}
+
+void FadeLedGroupBase::setTime(unsigned long time){
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may not see it halfway
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    unsigned long count = time / FadeLed::getInterval();
+    #if FADE_LED_MAX_INTERVALS < 4294967294UL
+    if(count > FADE_LED_MAX_INTERVALS){
+      count = FADE_LED_MAX_INTERVALS;
+    }
+    #endif
+    _countMax = count;
+
+    //continue the current fade with the new time, done if that already passed
+    if(_fading){
+      if(_count > _countMax){
+        _count = _countMax;
+      }
+      _progress.setup(_count, ProgressMax, _countMax);
+    }
+  }
+}
+
+#if FADE_LED_EASING
+void FadeLedGroupBase::setEasing(const uint16_t* easing){
+  _easing = easing;
+}
+#endif
+
+bool FadeLedGroupBase::done(){
+  return !_fading;
+}
+
+void FadeLedGroupBase::setGammaTable(const flvar_t* table, flvar_t biggestStep, byte segmentBits){
+  stop();
+  _gammaLookup = table;
+  _biggestStep = biggestStep;
+  _gammaSegmentBits = segmentBits;
+}
+
+void FadeLedGroupBase::noGammaTable(){
+  setGammaTable(nullptr, FADE_LED_RESOLUTION);
+}
+
+flvar_t FadeLedGroupBase::getBiggestStep(){
+  return _biggestStep;
+}
+
+void FadeLedGroupBase::setOutput(FadeLedOutput* output){
+  _output = output;
+}
+
+void FadeLedGroupBase::startFade(){
+  _fading = true;
+  _count = 1;
+  #if FADE_LED_ELAPSED_TIME
+  _startTick = FadeLed::currentTick();
+  #endif
+
+  _progress.setup(_count, ProgressMax, _countMax);
+}
+
+void FadeLedGroupBase::updateAll(){
+  for(FadeLedGroupBase* group = _groupList; group; group = group->_nextGroup){
+    if(!group->_fading){
+      continue;
+    }
+
+    #if FADE_LED_ELAPSED_TIME
+    //jump to the intervals passed since the fade started
+    unsigned long count = FadeLed::_tick - group->_startTick;
+    if(count > group->_countMax){
+      count = group->_countMax;
+    }
+    if(count != group->_count){
+      group->_count = count;
+      group->_progress.setup(count, ProgressMax, group->_countMax);
+    }
+    #endif
+
+    //last update of the fade ends exactly at the set brightness
+    if(group->_count >= group->_countMax){
+      group->_progress.pos = ProgressMax;
+      group->_progress.err = 0;
+      group->_fading = false;
+    }
+
+    //round progress up, otherwise a channel trails a single FadeLed by a step
+    unsigned int progress = group->_progress.pos + (group->_progress.err != 0);
+    #if FADE_LED_EASING
+    if(group->_easing){
+      progress = FadeLedEasingRead(group->_easing, progress);
+    }
+    #endif
+    group->updateThis(progress);
+
+    group->_count++;
+    group->_progress.next(group->_countMax);
+  }
+}
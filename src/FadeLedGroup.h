@@ -0,0 +1,297 @@
+/**
+ *  @file FadeLedGroup.h
+ *  @brief Fading multiple channels (like RGB or RGBW) together.
+ *
+ *  @details A FadeLedGroup fades a number of channels with one shared fade time, gamma table and output. All channels start and end on the same update so a color fade can't tear.
+ */
+
+#ifndef _FADE_LED_GROUP_H
+#define _FADE_LED_GROUP_H
+
+#include "FadeLed.h"
+
+/**
+ *  @brief Shared part of all FadeLedGroup's
+ *
+ *  @details Holds everything that isn't per channel: the fade time, the progress of the fade, the gamma table and the output. Use FadeLedGroup to make a group.
+ *
+ *  @see FadeLedGroup
+ */
+class FadeLedGroupBase{
+  public:
+    /**
+     *  @brief Set the time each fade takes
+     *
+     *  @details A group always fades in constant fade time. Every channel reaches its new brightness at the same update. Like FadeLed::setTime() it's a whole multiple of the interval. A running fade continues with the new time.
+     *
+     *  @param [in] time The time (ms) a fade will take
+     */
+    void setTime(unsigned long time);
+
+    #if FADE_LED_EASING
+    /**
+     *  @brief Set the easing curve of the fades
+     *
+     *  @details Same as FadeLed::setEasing(), all channels follow the same curve.
+     *
+     *  @param [in] easing Easing table in PROGMEM, FadeLedEaseLinear (nullptr, **default**) for a linear fade
+     */
+    void setEasing(const uint16_t* easing);
+    #endif
+
+    /**
+     *  @brief Returns if the group is done fading
+     */
+    bool done();
+
+    /**
+     *  @brief Stops the current fade
+     *
+     *  @details Makes the current brightness of each channel the set brightness.
+     */
+    virtual void stop() = 0;
+
+    /**
+     *  @brief Sets a gamma table to use for all channels
+     *
+     *  @details Same as FadeLed::setGammaTable() but for all channels. Stops the current fade.
+     *
+     *  @param [in] table The gamma table in PROGMEM, nullptr for no gamma correction
+     *  @param [in] biggestStep The biggest step of that gamma table
+     *  @param [in] segmentBits 0 for a full table, otherwise the segment size of a compressed table
+     */
+    void setGammaTable(const flvar_t* table, flvar_t biggestStep = 100, byte segmentBits = 0);
+
+    /**
+     *  @brief Use no gamma correction for full range
+     *
+     *  @details Same as FadeLed::noGammaTable() but for all channels.
+     */
+    void noGammaTable();
+
+    /**
+     *  @brief Get the biggest brightness step
+     */
+    flvar_t getBiggestStep();
+
+    /**
+     *  @brief Write the channels to an output backend
+     *
+     *  @details Like FadeLed::setOutput(), the pins of the group are used as channels of output.
+     *
+     *  @param [in] output The output to write to, nullptr to use analogWrite()
+     */
+    void setOutput(FadeLedOutput* output);
+
+    /**
+     *  @brief Updates all groups
+     *
+     *  @details Called by FadeLed::update() each interval once the first group is made, you don't need to call it yourself.
+     */
+    static void updateAll();
+
+  protected:
+    /**
+     *  @brief Constructor, links the group in the list updateAll() uses
+     */
+    FadeLedGroupBase();
+
+    /**
+     *  @brief Destructor, removes the group from the list updateAll() uses
+     */
+    virtual ~FadeLedGroupBase();
+
+    /**
+     *  @brief Updates the channels of this group
+     *
+     *  @details Implemented by FadeLedGroup so the loop over the channels is made for the number of channels.
+     *
+     *  @param [in] progress Progress of the fade in 1/32768 (32768 is done)
+     */
+    virtual void updateThis(unsigned int progress) = 0;
+
+    /**
+     *  @brief Starts a new fade from the current brightness
+     *
+     *  @details Resets the shared progress. Sets up the progress stepping (one division) so each update only adds.
+     */
+    void startFade();
+
+    /**
+     *  @brief Gives the output level for a given step
+     *
+     *  @details Same as FadeLed::getGamma()
+     */
+    flvar_t getGamma(flvar_t step);
+
+    flcount_t _countMax; //!< The number of intervals a fade takes
+    flcount_t _count; //!< The number of intervals passed
+    #if FADE_LED_ELAPSED_TIME
+    unsigned long _startTick; //!< FadeLed tick at which the fade started
+    #endif
+    FadeLedStep<unsigned int> _progress; //!< Progress at #_count in 1/32768, rounded down, and what to add each interval
+    const flvar_t* _gammaLookup; //!< Pointer to the gamma table in PROGMEM
+    #if FADE_LED_EASING
+    const uint16_t* _easing; //!< Easing table in PROGMEM, nullptr for linear
+    #endif
+    flvar_t _biggestStep; //!< The biggest input step possible
+    byte _gammaSegmentBits; //!< 0 for a full gamma table, otherwise a knot every 2^#_gammaSegmentBits steps
+    FadeLedOutput* _output; //!< Output backend, nullptr for analogWrite()
+    bool _fading; //!< A fade is in progress
+    FadeLedGroupBase* _nextGroup; //!< Next group in the list of groups
+
+    static FadeLedGroupBase* _groupList; //!< First group
+
+    static const unsigned int ProgressMax = 32768; //!< Progress of a finished fade
+};
+
+/**
+ *  @brief A group of channels that fade together
+ *
+ *  @details The brightness of the channels is stored in arrays (structure of arrays) and updated in one loop. The fade time, progress and gamma table are shared. Updated by FadeLed::update() like a FadeLed object. With #FADE_LED_ISR on another platform than AVR, only change it when the timer interrupt can't run.
+ *
+ *  ```C++
+ *  FadeLedGroup<3> rgbLed({9, 10, 11});
+ *
+ *  void setup(){
+ *    rgbLed.setTime(5000);
+ *  }
+ *
+ *  void loop(){
+ *    FadeLed::update();
+ *
+ *    if(rgbLed.done()){
+ *      const flvar_t color[3] = {100, 20, 0};
+ *      rgbLed.set(color);
+ *    }
+ *  }
+ *  ```
+ *
+ *  @tparam Channels Number of channels (3 for RGB, 4 for RGBW etc)
+ */
+template <byte Channels>
+class FadeLedGroup : public FadeLedGroupBase{
+  public:
+    /**
+     *  @brief Constructor of a group
+     *
+     *  @details All channels start at brightness 0.
+     *
+     *  @param [in] pins The PWM pin (or output channel) of each channel
+     */
+    FadeLedGroup(const byte (&pins)[Channels]){
+      for(byte i = 0; i < Channels; i++){
+        _pins[i] = pins[i];
+        _setVal[i] = 0;
+        _startVal[i] = 0;
+        _curVal[i] = 0;
+      }
+    }
+
+    /**
+     *  @brief Set the brightness of all channels directly, without fading
+     *
+     *  @param [in] vals The brightness of each channel
+     */
+    void begin(const flvar_t (&vals)[Channels]){
+      #if FADE_LED_ISR && defined(__AVR__)
+      //tick() may not see it halfway
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      #endif
+      {
+        _fading = false;
+        for(byte i = 0; i < Channels; i++){
+          _setVal[i] = limit(vals[i]);
+          _curVal[i] = _setVal[i];
+          FadeLed::writeOutput(_output, _pins[i], getGamma(_curVal[i]));
+        }
+      }
+    }
+
+    /**
+     *  @brief Set the brightness all channels fade to
+     *
+     *  @details All channels start fading from their current brightness on the next update and are done on the same update. Unlike a single FadeLed object in constant fade time a new set() while fading is **not** ignored, it just starts a new fade from the current brightness.
+     *
+     *  @param [in] vals The brightness to fade to for each channel
+     */
+    void set(const flvar_t (&vals)[Channels]){
+      #if FADE_LED_ISR && defined(__AVR__)
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      #endif
+      {
+        bool change = false;
+        for(byte i = 0; i < Channels; i++){
+          _startVal[i] = _curVal[i];
+          _setVal[i] = limit(vals[i]);
+          change |= (_setVal[i] != _curVal[i]);
+        }
+
+        if(change){
+          startFade();
+        }
+        else{
+          _fading = false;
+        }
+      }
+    }
+
+    /**
+     *  @brief Returns the last set brightness of a channel
+     */
+    flvar_t get(byte channel){
+      return _setVal[channel];
+    }
+
+    /**
+     *  @brief Returns the current brightness of a channel
+     */
+    flvar_t getCurrent(byte channel){
+      return _curVal[channel];
+    }
+
+    void stop(){
+      #if FADE_LED_ISR && defined(__AVR__)
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      #endif
+      {
+        _fading = false;
+        for(byte i = 0; i < Channels; i++){
+          _setVal[i] = _curVal[i];
+        }
+      }
+    }
+
+  protected:
+    byte _pins[Channels]; //!< Pin (or output channel) of each channel
+    flvar_t _setVal[Channels]; //!< Brightness each channel fades to
+    flvar_t _startVal[Channels]; //!< Brightness each channel started the fade at
+    flvar_t _curVal[Channels]; //!< Current brightness of each channel
+
+    flvar_t limit(flvar_t val){
+      return (val > _biggestStep) ? _biggestStep : val;
+    }
+
+    void updateThis(unsigned int progress){
+      flvar_t newVal[Channels];
+
+      //same math for every channel, no branches
+      for(byte i = 0; i < Channels; i++){
+        long diff = (long)_setVal[i] - (long)_startVal[i];
+        newVal[i] = _startVal[i] + diff * (long)progress / (long)ProgressMax;
+      }
+
+      for(byte i = 0; i < Channels; i++){
+        if(newVal[i] != _curVal[i]){
+          _curVal[i] = newVal[i];
+          FadeLed::writeOutput(_output, _pins[i], getGamma(_curVal[i]));
+        }
+      }
+    }
+};
+
+inline flvar_t FadeLedGroupBase::getGamma(flvar_t step){
+  return FadeLedGammaRead(_gammaLookup, _gammaSegmentBits, step);
+}
+
+#endif
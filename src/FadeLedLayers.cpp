@@ -0,0 +1,311 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+#include "FadeLedLayers.h"
+
+FadeLedLayersBase* FadeLedLayersBase::_layersList = nullptr;
+
+FadeLedLayersBase::FadeLedLayersBase(byte pin, FadeLedLayer* layers, byte count) :
+  _layers(layers),
+  _count(count),
+  _pin(pin),
+  _outVal(0),
+  _fading(false),
+  _gammaLookup(FadeLedGammaTable),
+  _biggestStep(100),
+  _gammaSegmentBits(0),
+  _output(nullptr),
+  _nextLayers(_layersList)
+{
+  _layersList = this;
+  FadeLed::_hooks[FadeLed::HookLayers] = updateAll;
+}
+
+FadeLedLayersBase::~FadeLedLayersBase(){
+  FadeLedLayersBase** link = &_layersList;
+  while(*link && *link != this){
+    link = &(*link)->_nextLayers;
+  }
+  if(*link){
+    *link = _nextLayers;
+  }
+}
+
+void FadeLedLayersBase::clearLayers(){
+  for(byte i = 0; i < _count; i++){
+    FadeLedLayer& layer = _layers[i];
+    layer.setVal = 0;
+    layer.startVal = 0;
+    layer.curVal = 0;
+    layer.blend = BlendHighest;
+    layer.constTime = false;
+    layer.active = (i == 0);
+    //like set in order of the layers, a higher layer wins if none is set yet
+    layer.rank = i;
+    layer.countMax = 40;
+    layer.count = 0;
+    #if FADE_LED_ELAPSED_TIME
+    layer.startTick = 0;
+    #endif
+    layer.step = FadeLedStep<flvar_t>();
+  }
+}
+
+void FadeLedLayersBase::setLatest(FadeLedLayer& layer){
+  for(byte i = 0; i < _count; i++){
+    if(_layers[i].rank > layer.rank){
+      _layers[i].rank--;
+    }
+  }
+  layer.rank = _count - 1;
+}
+
+void FadeLedLayersBase::setupStep(FadeLedLayer& layer){
+  //same distance as FadeLed::setupStep()
+  flvar_t dist = _biggestStep;
+  if(layer.constTime){
+    dist = (layer.setVal > layer.startVal) ? (layer.setVal - layer.startVal) : (layer.startVal - layer.setVal);
+  }
+
+  layer.step.setup(layer.count, dist, layer.countMax);
+}
+
+void FadeLedLayersBase::set(byte layer, flvar_t val){
+  if(layer >= _count){
+    return;
+  }
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may not see it halfway
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    FadeLedLayer& l = _layers[layer];
+    if(val > _biggestStep){
+      val = _biggestStep;
+    }
+    //nothing changes, like FadeLed::set()
+    if(l.active && l.setVal == val){
+      return;
+    }
+    l.setVal = val;
+    l.startVal = l.curVal;
+    l.count = 1;
+    #if FADE_LED_ELAPSED_TIME
+    l.startTick = FadeLed::currentTick();
+    #endif
+    setupStep(l);
+    setLatest(l);
+
+    //the blend changes if it wasn't in it
+    if(!l.active){
+      l.active = true;
+      show(false);
+    }
+    if(l.curVal != l.setVal){
+      _fading = true;
+    }
+  }
+}
+
+void FadeLedLayersBase::begin(byte layer, flvar_t val){
+  if(layer >= _count){
+    return;
+  }
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    FadeLedLayer& l = _layers[layer];
+    if(val > _biggestStep){
+      val = _biggestStep;
+    }
+    l.setVal = val;
+    l.curVal = val;
+    l.active = true;
+    setLatest(l);
+    show(true);
+  }
+}
+
+void FadeLedLayersBase::release(byte layer){
+  if(layer >= _count){
+    return;
+  }
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    FadeLedLayer& l = _layers[layer];
+    l.active = false;
+    l.setVal = l.curVal;
+    show(false);
+  }
+}
+
+void FadeLedLayersBase::setTime(byte layer, unsigned long time, bool constTime){
+  if(layer >= _count){
+    return;
+  }
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    FadeLedLayer& l = _layers[layer];
+    unsigned long count = time / FadeLed::getInterval();
+    #if FADE_LED_MAX_INTERVALS < 4294967294UL
+    if(count > FADE_LED_MAX_INTERVALS){
+      count = FADE_LED_MAX_INTERVALS;
+    }
+    #endif
+    l.countMax = count;
+    l.constTime = constTime;
+
+    //continue the current fade with the new time
+    if(l.curVal != l.setVal){
+      setupStep(l);
+    }
+  }
+}
+
+void FadeLedLayersBase::setBlend(byte layer, Blend blend){
+  if(layer >= _count){
+    return;
+  }
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    _layers[layer].blend = blend;
+    show(false);
+  }
+}
+
+flvar_t FadeLedLayersBase::get(byte layer){
+  if(layer >= _count){
+    return 0;
+  }
+  return _layers[layer].setVal;
+}
+
+flvar_t FadeLedLayersBase::getCurrent(byte layer){
+  if(layer >= _count){
+    return 0;
+  }
+  return _layers[layer].curVal;
+}
+
+flvar_t FadeLedLayersBase::getOutput(){
+  return _outVal;
+}
+
+bool FadeLedLayersBase::done(){
+  for(byte i = 0; i < _count; i++){
+    if(_layers[i].curVal != _layers[i].setVal){
+      return false;
+    }
+  }
+  return true;
+}
+
+void FadeLedLayersBase::setGammaTable(const flvar_t* table, flvar_t biggestStep, byte segmentBits){
+  for(byte i = 0; i < _count; i++){
+    _layers[i].setVal = _layers[i].curVal;
+  }
+  _fading = false;
+  _gammaLookup = table;
+  _biggestStep = biggestStep;
+  _gammaSegmentBits = segmentBits;
+}
+
+void FadeLedLayersBase::noGammaTable(){
+  setGammaTable(nullptr, FADE_LED_RESOLUTION);
+}
+
+flvar_t FadeLedLayersBase::getBiggestStep(){
+  return _biggestStep;
+}
+
+void FadeLedLayersBase::setOutput(FadeLedOutput* output){
+  _output = output;
+}
+
+void FadeLedLayersBase::updateAll(){
+  for(FadeLedLayersBase* layers = _layersList; layers; layers = layers->_nextLayers){
+    if(layers->_fading){
+      layers->updateThis();
+    }
+  }
+}
+
+void FadeLedLayersBase::updateThis(){
+  bool fading = false;
+  for(byte i = 0; i < _count; i++){
+    FadeLedLayer& layer = _layers[i];
+    if(layer.curVal != layer.setVal){
+      fadeLayer(layer);
+      fading |= (layer.curVal != layer.setVal);
+    }
+  }
+  _fading = fading;
+
+  //once, for all layers that moved
+  show(false);
+}
+
+void FadeLedLayersBase::fadeLayer(FadeLedLayer& layer){
+  #if FADE_LED_ELAPSED_TIME
+  //jump to the intervals passed since the fade started
+  unsigned long count = FadeLed::_tick - layer.startTick;
+  if(count > layer.countMax){
+    count = layer.countMax;
+  }
+  if(count != layer.count){
+    layer.count = count;
+    setupStep(layer);
+  }
+  #endif
+
+  //same steps as FadeLed::updateThis()
+  layer.curVal = FadeLedStepTo(layer.startVal, layer.setVal, layer.step.pos);
+  layer.count++;
+  layer.step.next(layer.countMax);
+}
+
+flvar_t FadeLedLayersBase::blend(){
+  unsigned long out = 0;
+  byte rank = 0;
+  for(byte i = 0; i < _count; i++){
+    const FadeLedLayer& layer = _layers[i];
+    if(!layer.active){
+      continue;
+    }
+
+    //from 0 every mode gives the bottom layer itself
+    if(layer.blend == BlendLatest){
+      if(layer.rank >= rank){
+        out = layer.curVal;
+      }
+    }
+    else if(layer.blend == BlendAdd){
+      out += layer.curVal;
+      if(out > _biggestStep){
+        out = _biggestStep;
+      }
+    }
+    else if(layer.curVal > out){
+      out = layer.curVal;
+    }
+
+    if(layer.rank > rank){
+      rank = layer.rank;
+    }
+  }
+  return out;
+}
+
+void FadeLedLayersBase::show(bool force){
+  flvar_t out = blend();
+  if(out != _outVal || force){
+    _outVal = out;
+    FadeLed::writeOutput(_output, _pin, FadeLedGammaRead(_gammaLookup, _gammaSegmentBits, out));
+  }
+}
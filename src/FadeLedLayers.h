@@ -0,0 +1,277 @@
+/**
+ *  @file FadeLedLayers.h
+ *  @brief Fading a pin with several layers of fades blended together.
+ *
+ *  @details A FadeLed object has one fade. A FadeLedLayers has a few, each layer with its own brightness and fade time, and blends them into the brightness of the pin. Like a slow breathing on top of a base level, or a flash that goes back to the fade that was running underneath. The layers are blended once per update in one pass, before the gamma correction.
+ */
+
+#ifndef _FADE_LED_LAYERS_H
+#define _FADE_LED_LAYERS_H
+
+#include "FadeLed.h"
+
+/**
+ *  @brief One layer of a FadeLedLayers
+ */
+struct FadeLedLayer{
+  flvar_t setVal; //!< Brightness it fades to
+  flvar_t startVal; //!< Brightness the fade started at
+  flvar_t curVal; //!< Current brightness
+  byte blend; //!< How it's blended with the layers below, one of #FadeLedLayersBase::Blend
+  bool constTime; //!< Constant time fade or just constant speed fade
+  bool active; //!< Takes part in the blend
+  byte rank; //!< Order in which the layers were last set, the latest has the highest, for #FadeLedLayersBase::BlendLatest
+  flcount_t countMax; //!< The number of intervals a fade takes
+  flcount_t count; //!< The number of intervals passed
+  #if FADE_LED_ELAPSED_TIME
+  unsigned long startTick; //!< FadeLed tick at which the fade started
+  #endif
+  FadeLedStep<flvar_t> step; //!< Steps faded at #count and what to add each interval
+};
+
+/**
+ *  @brief Shared part of all FadeLedLayers
+ *
+ *  @details Holds everything but the layers themselves. Use FadeLedLayers to make one.
+ *
+ *  @see FadeLedLayers
+ */
+class FadeLedLayersBase{
+  public:
+    /**
+     *  @brief How a layer is blended with the layers below it
+     */
+    enum Blend{
+      BlendHighest, //!< Highest takes precedence (HTP): the highest brightness wins, **default**
+      BlendLatest, //!< Latest takes precedence (LTP): the layer wins if it was set later than the layers below
+      BlendAdd //!< Added to the layers below, limited to getBiggestStep()
+    };
+
+    /**
+     *  @brief Set the brightness a layer fades to
+     *
+     *  @details The layer starts fading from its current brightness on the next update and takes part in the blend (again). Like FadeLedGroup a new brightness while fading is **not** ignored, it starts a new fade. Also in constant fade time. The same brightness again changes nothing.
+     *
+     *  @param [in] layer The layer, 0 is the bottom one. A layer that isn't there is ignored
+     *  @param [in] val   The brightness to fade to, limited to getBiggestStep()
+     */
+    void set(byte layer, flvar_t val);
+
+    /**
+     *  @brief Set the brightness of a layer directly, without fading
+     *
+     *  @details The layer takes part in the blend (again). The output is written right away.
+     *
+     *  @param [in] layer The layer, 0 is the bottom one. A layer that isn't there is ignored
+     *  @param [in] val   The brightness, limited to getBiggestStep()
+     */
+    void begin(byte layer, flvar_t val);
+
+    /**
+     *  @brief Take a layer out of the blend
+     *
+     *  @details The output goes back to the blend of the other layers right away, a fade of the layer stops. The next set() or begin() of the layer puts it back.
+     *
+     *  @param [in] layer The layer, 0 is the bottom one. A layer that isn't there is ignored
+     */
+    void release(byte layer);
+
+    /**
+     *  @brief Set the time a fade of a layer takes
+     *
+     *  @details Same as FadeLed::setTime(), per layer.
+     *
+     *  @param [in] layer     The layer, 0 is the bottom one. A layer that isn't there is ignored
+     *  @param [in] time      The time (ms) a fade takes
+     *  @param [in] constTime **true** for constant fade time, **false** (default) for constant fade speed (time of a fade over the full range)
+     */
+    void setTime(byte layer, unsigned long time, bool constTime = false);
+
+    /**
+     *  @brief Set how a layer is blended with the layers below it
+     *
+     *  @details The bottom layer (0) is not blended with anything, its mode does nothing.
+     *
+     *  @param [in] layer The layer, a layer that isn't there is ignored
+     *  @param [in] blend One of #Blend, **default** #BlendHighest
+     */
+    void setBlend(byte layer, Blend blend);
+
+    /**
+     *  @brief Returns the brightness a layer fades to (or is at), 0 for a layer that isn't there
+     */
+    flvar_t get(byte layer);
+
+    /**
+     *  @brief Returns the current brightness of a layer, 0 for a layer that isn't there
+     */
+    flvar_t getCurrent(byte layer);
+
+    /**
+     *  @brief Returns the blended brightness of the pin
+     */
+    flvar_t getOutput();
+
+    /**
+     *  @brief Returns if all layers are done fading
+     */
+    bool done();
+
+    /**
+     *  @brief Sets a gamma table
+     *
+     *  @details Same as FadeLedGroupBase::setGammaTable(), for the blended brightness. Stops all fades.
+     *
+     *  @param [in] table The gamma table in PROGMEM, nullptr for no gamma correction
+     *  @param [in] biggestStep The biggest step of that gamma table
+     *  @param [in] segmentBits 0 for a full table, otherwise the segment size of a compressed table
+     */
+    void setGammaTable(const flvar_t* table, flvar_t biggestStep = 100, byte segmentBits = 0);
+
+    /**
+     *  @brief Use no gamma correction for full range
+     */
+    void noGammaTable();
+
+    /**
+     *  @brief Get the biggest brightness step
+     */
+    flvar_t getBiggestStep();
+
+    /**
+     *  @brief Write to an output backend
+     *
+     *  @details Like FadeLed::setOutput(), the pin is the channel of the output.
+     *
+     *  @param [in] output The output to write to, nullptr to use analogWrite()
+     */
+    void setOutput(FadeLedOutput* output);
+
+    /**
+     *  @brief Updates all FadeLedLayers
+     *
+     *  @details Called by FadeLed::update() each interval once the first FadeLedLayers is made, you don't need to call it yourself.
+     */
+    static void updateAll();
+
+  protected:
+    /**
+     *  @brief Constructor, links it in the list updateAll() uses
+     *
+     *  @param [in] pin    The PWM pin (or output channel)
+     *  @param [in] layers The layers
+     *  @param [in] count  Number of layers
+     */
+    FadeLedLayersBase(byte pin, FadeLedLayer* layers, byte count);
+
+    /**
+     *  @brief Destructor, removes it from the list updateAll() uses
+     */
+    ~FadeLedLayersBase();
+
+    /**
+     *  @brief Sets all layers to brightness 0, only the bottom one in the blend
+     *
+     *  @details Called by FadeLedLayers once its layers are made.
+     */
+    void clearLayers();
+
+    /**
+     *  @brief Makes a layer the latest set, for #BlendLatest
+     *
+     *  @details The layers set after it move down a rank.
+     */
+    void setLatest(FadeLedLayer& layer);
+
+    /**
+     *  @brief Sets the stepping of a layer up for its current count
+     */
+    void setupStep(FadeLedLayer& layer);
+
+    /**
+     *  @brief Moves the fades of all layers one interval and shows the blend
+     */
+    void updateThis();
+
+    /**
+     *  @brief Moves the fade of a layer one interval (or to the current tick)
+     */
+    void fadeLayer(FadeLedLayer& layer);
+
+    /**
+     *  @brief Blends all layers, in one pass from the bottom up
+     *
+     *  @return The blended brightness
+     */
+    flvar_t blend();
+
+    /**
+     *  @brief Blends all layers and writes the output if it changed
+     *
+     *  @param [in] force Write the output also if it didn't change
+     */
+    void show(bool force);
+
+    FadeLedLayer* const _layers; //!< The layers, the bottom one first
+    const byte _count; //!< Number of layers
+    const byte _pin; //!< PWM pin (or output channel)
+    flvar_t _outVal; //!< Blended brightness last shown
+    bool _fading; //!< A layer is fading
+    const flvar_t* _gammaLookup; //!< Pointer to the gamma table in PROGMEM
+    flvar_t _biggestStep; //!< The biggest input step possible
+    byte _gammaSegmentBits; //!< 0 for a full gamma table, otherwise a knot every 2^#_gammaSegmentBits steps
+    FadeLedOutput* _output; //!< Output backend, nullptr for analogWrite()
+    FadeLedLayersBase* _nextLayers; //!< Next in the list of all FadeLedLayers
+
+    static FadeLedLayersBase* _layersList; //!< First FadeLedLayers
+};
+
+/**
+ *  @brief A pin with a number of fade layers blended together
+ *
+ *  @details Each layer fades like a FadeLed object (constant fade time or constant fade speed) and is blended with the layers below it: highest takes precedence, latest takes precedence or added. Each update every fading layer moves and all layers are blended in one pass, before the gamma correction. The output is only written if the blend changed. Updated by FadeLed::update() like a FadeLed object. With #FADE_LED_ISR on another platform than AVR, only change it when the timer interrupt can't run.
+ *
+ *  ```C++
+ *  FadeLedLayers<2> led(5);
+ *
+ *  void setup(){
+ *    led.begin(0, 30);      //base level
+ *    led.setTime(1, 100, true);
+ *    led.setBlend(1, FadeLedLayersBase::BlendLatest);
+ *  }
+ *
+ *  void flash(){
+ *    led.begin(1, 100);     //flash on top
+ *    led.set(1, 0);         //and fade out in 100ms
+ *  }
+ *
+ *  void flashDone(){
+ *    led.release(1);        //back to the base level
+ *  }
+ *  ```
+ *
+ *  The bottom layer (0) takes part in the blend from the start (at 0), the others from their first set() or begin().
+ *
+ *  @tparam Layers Number of layers
+ */
+template <byte Layers>
+class FadeLedLayers : public FadeLedLayersBase{
+  static_assert(Layers >= 1, "At least one layer");
+
+  public:
+    /**
+     *  @brief Constructor
+     *
+     *  @details All layers at brightness 0 in constant fade speed with a fade time of 2 seconds (at an interval of 50ms), blended with #BlendHighest.
+     *
+     *  @param [in] pin The PWM pin (or output channel)
+     */
+    FadeLedLayers(byte pin) : FadeLedLayersBase(pin, _layerList, Layers){
+      clearLayers();
+    }
+
+  protected:
+    FadeLedLayer _layerList[Layers]; //!< The layers
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+
+#if FADE_LED_MASTER
+FadeLedMaster* FadeLedMaster::_masterList = nullptr;
+
+FadeLedMaster::FadeLedMaster(FadeLedMaster* parent) :
+  _parent(parent),
+  _pos((uint16_t)Full << 8),
+  _startPos((uint16_t)Full << 8),
+  _setPos((uint16_t)Full << 8),
+  _countMax(40),
+  #if FADE_LED_TICKS
+  _startTick(0),
+  #else
+  _count(0),
+  #endif
+  _scale(One),
+  _changed(false),
+  _nextMaster(_masterList)
+{
+  _masterList = this;
+}
+
+FadeLedMaster::~FadeLedMaster(){
+  FadeLedMaster** link = &_masterList;
+  while(*link && *link != this){
+    link = &(*link)->_nextMaster;
+  }
+  if(*link){
+    *link = _nextMaster;
+  }
+}
+
+void FadeLedMaster::set(byte level){
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may not see it halfway
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    _startPos = _pos;
+    _setPos = (uint16_t)level << 8;
+    #if FADE_LED_TICKS
+    _startTick = FadeLed::currentTick();
+    #else
+    _count = 0;
+    #endif
+  }
+}
+
+void FadeLedMaster::begin(byte level){
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    _setPos = (uint16_t)level << 8;
+    _startPos = _setPos;
+    _pos = _setPos;
+  }
+}
+
+void FadeLedMaster::setTime(unsigned long time){
+  unsigned long count = time / FadeLed::getInterval();
+  if(count > 0xFFFF){
+    count = 0xFFFF;
+  }
+  _countMax = count;
+}
+
+void FadeLedMaster::setParent(FadeLedMaster* parent){
+  _parent = parent;
+}
+
+byte FadeLedMaster::get(){
+  return _setPos >> 8;
+}
+
+byte FadeLedMaster::getCurrent(){
+  return _pos >> 8;
+}
+
+bool FadeLedMaster::done(){
+  return _pos == _setPos;
+}
+
+uint32_t FadeLedMaster::getScale(){
+  return _scale;
+}
+
+bool FadeLedMaster::updateAll(){
+  //first all levels, a scale needs the levels of the masters above
+  for(FadeLedMaster* master = _masterList; master; master = master->_nextMaster){
+    if(master->_pos != master->_setPos){
+      master->updateThis();
+    }
+  }
+
+  bool changed = false;
+  for(FadeLedMaster* master = _masterList; master; master = master->_nextMaster){
+    uint32_t scale = master->ownScale();
+    for(FadeLedMaster* parent = master->_parent; parent; parent = parent->_parent){
+      uint32_t parentScale = parent->ownScale();
+      //fits, parentScale is less than One
+      if(parentScale != One){
+        scale = (scale * parentScale) >> 16;
+      }
+    }
+    master->_changed = (scale != master->_scale);
+    master->_scale = scale;
+    changed |= master->_changed;
+  }
+  return changed;
+}
+
+void FadeLedMaster::updateThis(){
+  #if FADE_LED_TICKS
+  unsigned long count = FadeLed::_tick - _startTick;
+  #else
+  unsigned long count = ++_count;
+  #endif
+
+  if(count >= _countMax){
+    _pos = _setPos;
+  }
+  //fits, the distance and the count are both 16-bit
+  else if(_setPos > _startPos){
+    _pos = _startPos + (unsigned long)(_setPos - _startPos) * count / _countMax;
+  }
+  else{
+    _pos = _startPos - (unsigned long)(_startPos - _setPos) * count / _countMax;
+  }
+}
+
+uint32_t FadeLedMaster::ownScale(){
+  //so #Full is exactly One
+  return (uint32_t)_pos + (_pos >> 8) + (_pos >> 15);
+}
+
+void FadeLed::setMaster(FadeLedMaster* master){
+  _master = master;
+  write(outputLevel(_curVal));
+}
+
+FadeLedMaster* FadeLed::getMaster(){
+  return _master;
+}
+
+flvar_t FadeLed::dimmedLevel(flvar_t step){
+  //step in 1/256 times the scale in 1/256, fits as the scale is less than One
+  unsigned long pos = ((unsigned long)step << 8) * (_master->_scale >> 8) >> 8;
+  flvar_t low = pos >> 8;
+  unsigned int frac = pos & 0xFF;
+
+  //between two steps of the gamma table
+  unsigned long out = (unsigned long)getGamma(low) << 8;
+  if(frac){
+    out += (long)frac * ((long)getGamma(low + 1) - (long)getGamma(low));
+  }
+  return (out + 0x80) >> 8;
+}
+
+void FadeLed::redimAll(){
+  for(FadeLed* led = _ledFirst; led; led = led->_nextLed){
+    if(!led->masterChanged()){
+      continue;
+    }
+    #if FADE_LED_DITHER
+    //written with dithering in this tick already
+    if(led->_dither && !led->doneNow()){
+      continue;
+    }
+    #endif
+    led->write(led->outputLevel(led->_curVal));
+  }
+}
+#endif
@@ -0,0 +1,153 @@
+/**
+ *  @file FadeLedMaster.h
+ *  @brief Master dimmers that scale the output of many FadeLed objects.
+ *
+ *  @details With #FADE_LED_MASTER a FadeLed object can be linked to a FadeLedMaster, and a master to a master above it. Like a lighting desk: a global master, a master per zone and the LEDs in that zone. Changing a master only changes the master, the fades of the LEDs go on. Each update the scale of all masters is worked out once, the LEDs are only multiplied by it when their output is written.
+ */
+
+#ifndef _FADE_LED_MASTER_H
+#define _FADE_LED_MASTER_H
+
+class FadeLed;
+
+/**
+ *  @brief A master dimmer for FadeLed objects
+ *
+ *  @details Has a level from 0 (off) to 255 (#Full, not dimmed) that fades in constant fade time. The brightness of each FadeLed object linked to it (FadeLed::setMaster()) is scaled by its level, and by the level of the masters above it, just before the gamma correction. So half is half the perceived brightness, whatever the object is at.
+ *
+ *  ```C++
+ *  FadeLedMaster house;
+ *  FadeLedMaster kitchen(&house);
+ *  FadeLedMaster garden(&house);
+ *
+ *  FadeLed leds[3] = {3, 5, 6};
+ *
+ *  void setup(){
+ *    leds[0].setMaster(&kitchen);
+ *    leds[1].setMaster(&kitchen);
+ *    leds[2].setMaster(&garden);
+ *
+ *    garden.setTime(3000);
+ *    garden.set(64); //a quarter, in 3 seconds
+ *  }
+ *
+ *  void loop(){
+ *    FadeLed::update();
+ *  }
+ *  ```
+ *
+ *  A change takes effect on the next update. With #FADE_LED_ISR on another platform than AVR, or with #FADE_LED_MULTICORE, only change a master when the timer interrupt can't run or from the core that calls update(). A master must live as long as the objects and masters linked to it, and a master may not end up above itself.
+ */
+class FadeLedMaster{
+  public:
+    static const byte Full = 255; //!< Level that doesn't dim
+    static const uint32_t One = 65536UL; //!< Scale (in 1/65536) that doesn't dim
+
+    /**
+     *  @brief Constructor, starts at #Full
+     *
+     *  @details Links the master in the list FadeLed::update() uses. The fade time is 2 seconds at an interval of 50ms.
+     *
+     *  @param [in] parent The master above this one, nullptr (default) for none
+     */
+    FadeLedMaster(FadeLedMaster* parent = nullptr);
+
+    /**
+     *  @brief Destructor, removes the master from the list FadeLed::update() uses
+     */
+    ~FadeLedMaster();
+
+    /**
+     *  @brief Fade to a level
+     *
+     *  @details Starts a new fade from the current level, also while fading.
+     *
+     *  @param [in] level The level, 0 (off) to #Full
+     */
+    void set(byte level);
+
+    /**
+     *  @brief Set a level directly, without fading
+     *
+     *  @param [in] level The level, 0 (off) to #Full
+     */
+    void begin(byte level);
+
+    /**
+     *  @brief Set the time a fade of the master takes
+     *
+     *  @details Always constant fade time, a running fade goes on with the new time.
+     *
+     *  @param [in] time The time (ms) a fade takes, max 65535 intervals
+     */
+    void setTime(unsigned long time);
+
+    /**
+     *  @brief Set the master above this one
+     *
+     *  @param [in] parent The master above this one, nullptr for none
+     */
+    void setParent(FadeLedMaster* parent);
+
+    /**
+     *  @brief Returns the level it fades to (or is at)
+     */
+    byte get();
+
+    /**
+     *  @brief Returns the current level
+     */
+    byte getCurrent();
+
+    /**
+     *  @brief Returns if it's done fading
+     */
+    bool done();
+
+    /**
+     *  @brief Returns the scale of the objects linked to it, in 1/65536
+     *
+     *  @details The level of this master times those of the masters above it, as of the last update. #One if none of them dims.
+     */
+    uint32_t getScale();
+
+    /**
+     *  @brief Fades all masters and works out their scale
+     *
+     *  @details Called by FadeLed::update() each interval, you don't need to call it yourself.
+     *
+     *  @return true if the scale of a master changed, then the objects linked to it must be written again
+     */
+    static bool updateAll();
+
+  protected:
+    /**
+     *  @brief Moves the fade of the master one interval (or to the current tick)
+     */
+    void updateThis();
+
+    /**
+     *  @brief Scale of the level of this master alone, in 1/65536
+     */
+    uint32_t ownScale();
+
+    FadeLedMaster* _parent; //!< Master above this one, nullptr for none
+    uint16_t _pos; //!< Current level in 1/256
+    uint16_t _startPos; //!< Level the fade started at in 1/256
+    uint16_t _setPos; //!< Level it fades to in 1/256
+    uint16_t _countMax; //!< The number of intervals a fade takes
+    #if FADE_LED_TICKS
+    unsigned long _startTick; //!< FadeLed tick at which the fade started
+    #else
+    uint16_t _count; //!< The number of intervals passed
+    #endif
+    uint32_t _scale; //!< Scale of the objects linked to it (in 1/65536) at the last update
+    bool _changed; //!< #_scale changed at the last update
+    FadeLedMaster* _nextMaster; //!< Next in the list of all masters
+
+    static FadeLedMaster* _masterList; //!< First master
+
+    friend class FadeLed;
+};
+
+#endif
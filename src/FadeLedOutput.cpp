@@ -0,0 +1,95 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+
+FadeLedOutput* FadeLedOutput::_outputList = nullptr;
+
+FadeLedOutput::FadeLedOutput(flvar_t* frame, unsigned int channels) :
+  _frame(frame),
+  _channels(channels),
+  _dirtyRange(Clean),
+  _nextOutput(_outputList)
+{
+  for(unsigned int i = 0; i < _channels; i++){
+    _frame[i] = 0;
+  }
+  _outputList = this;
+}
+
+FadeLedOutput::~FadeLedOutput(){
+  FadeLedOutput** link = &_outputList;
+  while(*link && *link != this){
+    link = &(*link)->_nextOutput;
+  }
+  if(*link){
+    *link = _nextOutput;
+  }
+}
+
+void FadeLedOutput::write(byte channel, flvar_t val){
+  if(channel >= _channels || _frame[channel] == val){
+    return;
+  }
+
+  _frame[channel] = val;
+
+  //grow the range to send
+  byte first = _dirtyRange >> 8;
+  byte last = _dirtyRange & 0xFF;
+  if(_dirtyRange == Clean){
+    first = channel;
+    last = channel;
+  }
+  else if(channel < first){
+    first = channel;
+  }
+  else if(channel > last){
+    last = channel;
+  }
+  
+  #if FADE_LED_ISR && !defined(__AVR__)
+  //after the level, flushAll() may take the range any moment
+  __atomic_store_n(&_dirtyRange, (uint16_t)((first << 8) | last), __ATOMIC_RELEASE);
+  #else
+  _dirtyRange = (first << 8) | last;
+  #endif
+}
+
+flvar_t FadeLedOutput::read(byte channel){
+  if(channel >= _channels){
+    return 0;
+  }
+  #if FADE_LED_ISR && defined(__AVR__) && FADE_LED_PWM_BITS > 8
+  //tick() may not change it halfway reading
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+    return _frame[channel];
+  }
+  #endif
+  return _frame[channel];
+}
+
+bool FadeLedOutput::dirty(){
+  return _dirtyRange != Clean;
+}
+
+void FadeLedOutput::flushAll(){
+  for(FadeLedOutput* output = _outputList; output; output = output->_nextOutput){
+    //take the range and mark it clean in one go, tick() may write again meanwhile
+    uint16_t range;
+    #if FADE_LED_ISR && defined(__AVR__)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    #endif
+    {
+      #if FADE_LED_ISR && !defined(__AVR__)
+      range = __atomic_exchange_n(&output->_dirtyRange, Clean, __ATOMIC_ACQ_REL);
+      #else
+      range = output->_dirtyRange;
+      output->_dirtyRange = Clean;
+      #endif
+    }
+    
+    //flush() may write again, that's for the next flush
+    if(range != Clean){
+      output->flush(range >> 8, range & 0xFF);
+    }
+  }
+}
@@ -0,0 +1,106 @@
+/**
+ *  @file FadeLedOutput.h
+ *  @brief Output backends for FadeLed, for example I2C/SPI PWM drivers.
+ *
+ *  @details By default FadeLed writes a new brightness directly with analogWrite(). A FadeLed object linked to a FadeLedOutput (FadeLed::setOutput()) instead writes to a channel in the frame buffer of that output. FadeLed::update() sends all changed channels of each output once per update in a single burst.
+ */
+
+#ifndef _FADE_LED_OUTPUT_H
+#define _FADE_LED_OUTPUT_H
+
+/**
+ *  @brief Base class of an output backend
+ *
+ *  @details Keeps a frame buffer with the level of each channel and which channels changed since the last flush. Make a backend by deriving from it and implementing flush(). For example for a PCA9685:
+ *
+ *  ```C++
+ *  class Pca9685 : public FadeLedOutput{
+ *    public:
+ *      Pca9685() : FadeLedOutput(_levels, 16) {}
+ *
+ *    protected:
+ *      flvar_t _levels[16];
+ *
+ *      void flush(byte first, byte last){
+ *        //write the registers of channel first up to and including last in one auto-increment write
+ *      }
+ *  };
+ *  ```
+ *
+ *  See the 'OutputPCA9685.ino' example for a complete backend.
+ *
+ *  @see FadeLed::setOutput()
+ */
+class FadeLedOutput{
+  public:
+    /**
+     *  @brief Constructor of an output
+     *
+     *  @details Links the output in the list of outputs FadeLed::update() flushes. The frame buffer is supplied by the derived class so no heap is used. All channels start at 0 and clean.
+     *
+     *  @param [in] frame    Frame buffer of at least channels levels
+     *  @param [in] channels Number of channels of the output (max 256)
+     */
+    FadeLedOutput(flvar_t* frame, unsigned int channels);
+
+    /**
+     *  @brief Destructor of an output
+     *
+     *  @details Removes it from the list of outputs. Don't destroy an output while FadeLed objects still write to it.
+     */
+    virtual ~FadeLedOutput();
+
+    /**
+     *  @brief Sets the level of a channel
+     *
+     *  @details Only stores it in the frame buffer. If it's a new level the channel is marked dirty. It's send with the next flush.
+     *
+     *  @param [in] channel The channel to set. Channels outside the output are ignored.
+     *  @param [in] val     The output level
+     */
+    void write(byte channel, flvar_t val);
+
+    /**
+     *  @brief Returns the level of a channel in the frame buffer
+     *
+     *  @details Use it in flush(), with #FADE_LED_ISR it reads a level tick() writes meanwhile in one go.
+     *
+     *  @param [in] channel The channel
+     *  @return The level of that channel, 0 if outside the output
+     */
+    flvar_t read(byte channel);
+
+    /**
+     *  @brief Returns if there are channels changed since the last flush
+     */
+    bool dirty();
+
+    /**
+     *  @brief Flushes all outputs that have changed channels
+     *
+     *  @details Calls flush() once for each dirty output with the range of changed channels. Called by FadeLed::update() so you only need to call it yourself if you want a change made outside of it (like FadeLed::begin()) to be send directly.
+     */
+    static void flushAll();
+
+  protected:
+    /**
+     *  @brief Sends the changed channels to the hardware
+     *
+     *  @details Implement this in the backend. Channels first up to and including last are (or might be) changed. Send them in one transaction if the hardware allows. Get the levels with read(). With #FADE_LED_ISR the timer interrupt can change a level while it's flushed, that channel is then send again with the next flush.
+     *
+     *  @param [in] first First changed channel
+     *  @param [in] last  Last changed channel
+     */
+    virtual void flush(byte first, byte last) = 0;
+
+    flvar_t* const _frame; //!< Level of each channel
+    const unsigned int _channels; //!< Number of channels
+    uint16_t _dirtyRange; //!< First (high byte) and last (low byte) channel changed since the last flush, #Clean if none
+    FadeLedOutput* _nextOutput; //!< Next output in the list of outputs
+
+    static FadeLedOutput* _outputList; //!< First output
+
+    static const uint16_t Clean = 0xFF00; //!< #_dirtyRange without changed channels, the first after the last
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+#include "FadeLedScene.h"
+
+FadeLedScene::FadeLedScene(FadeLed* const* leds, const flvar_t* levels, unsigned int count, bool progmem) :
+  _leds(leds),
+  _levels(levels),
+  _count(count),
+  _progmem(progmem)
+  #if FADE_LED_QUEUE
+  ,
+  _queued(0),
+  _applied(0)
+  #endif
+{
+  
+}
+
+FadeLedScene::~FadeLedScene(){
+  #if FADE_LED_QUEUE
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may not see it halfway
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #elif FADE_LED_LOCK
+  //wait for a tick() or update() on another core, like the destructor of FadeLed
+  while(!FadeLed::lockEngine()){
+    delay(1);
+  }
+  #endif
+  {
+    FadeLed::dropCommands(this);
+  }
+  #if FADE_LED_LOCK
+  FadeLed::unlockEngine();
+  #endif
+  #endif
+}
+
+void FadeLedScene::fade(unsigned long time){
+  #if FADE_LED_QUEUE
+  FadeLed::pushCommand(this, _queued, FadeLed::CommandScene, time, false);
+  #else
+  fadeNow(time);
+  #endif
+}
+
+bool FadeLedScene::done(){
+  #if FADE_LED_QUEUE
+  //a fade() tick() didn't handle yet
+  if(__atomic_load_n(&_queued, __ATOMIC_RELAXED) != __atomic_load_n(&_applied, __ATOMIC_ACQUIRE)){
+    return false;
+  }
+  #endif
+  for(unsigned int i = 0; i < _count; i++){
+    if(_leds[i] && !_leds[i]->done()){
+      return false;
+    }
+  }
+  return true;
+}
+
+flvar_t FadeLedScene::getLevel(unsigned int index){
+  if(index >= _count){
+    return 0;
+  }
+  return _progmem ? FadeLedGammaReadLevel(_levels + index) : _levels[index];
+}
+
+unsigned int FadeLedScene::getCount(){
+  return _count;
+}
+
+void FadeLedScene::fadeNow(unsigned long time){
+  //same as FadeLed::setTimeNow()
+  unsigned long countMax = time / FadeLed::_interval;
+  #if FADE_LED_MAX_INTERVALS < 4294967294UL
+  if(countMax > FADE_LED_MAX_INTERVALS){
+    countMax = FADE_LED_MAX_INTERVALS;
+  }
+  #endif
+  
+  //one start for all
+  #if FADE_LED_TICKS
+  unsigned long startTick = FadeLed::currentTick();
+  #else
+  unsigned long startTick = 0;
+  #endif
+  
+  for(unsigned int i = 0; i < _count; i++){
+    if(_leds[i]){
+      _leds[i]->startScene(getLevel(i), countMax, startTick);
+    }
+  }
+}
+
+void FadeLedScene::captureLevels(flvar_t* levels){
+  for(unsigned int i = 0; i < _count; i++){
+    levels[i] = _leds[i] ? _leds[i]->get() : 0;
+  }
+}
@@ -0,0 +1,159 @@
+/**
+ *  @file FadeLedScene.h
+ *  @brief Crossfading all FadeLed objects to a scene at once.
+ *
+ *  @details A scene is a list of FadeLed objects and a brightness for each of them. Fading to a scene starts the fade of every object at the same tick with the same time, in one call. No setTime() and set() per object, so no checks of the fade an object is in and no objects that start a tick later.
+ */
+
+#ifndef _FADE_LED_SCENE_H
+#define _FADE_LED_SCENE_H
+
+#include "FadeLed.h"
+
+/**
+ *  @brief A scene: a brightness for each of a list of FadeLed objects
+ *
+ *  @details The first brightness is for the first object of the list, the second for the next and so on. Other objects are left alone, a nullptr in the list is skipped. The list is in RAM, the brightnesses in PROGMEM (default) or in RAM. Neither is copied, so both and the objects must stay as long as the scene is used. Use FadeLedSnapshot for a scene in RAM that can store the brightnesses of now.
+ *
+ *  ```C++
+ *  FadeLed leds[3] = {3, 5, 6};
+ *  FadeLed* const Leds[] = {&leds[0], &leds[1], &leds[2]};
+ *
+ *  const flvar_t Evening[] PROGMEM = {20, 60, 0};
+ *  FadeLedScene evening(Leds, Evening, 3);
+ *
+ *  void setup(){
+ *    evening.fade(5000); //all three in 5 seconds
+ *  }
+ *  ```
+ *
+ *  A fade to a scene replaces the fade each object is in, from its current brightness. It leaves each object in constant fade time with the time of the scene, like after setTime(time, true).
+ */
+class FadeLedScene{
+  public:
+    /**
+     *  @brief Constructor
+     *
+     *  @param [in] leds     The objects of the scene, in the order of levels
+     *  @param [in] levels   The brightness of each object
+     *  @param [in] count    Number of objects and brightnesses
+     *  @param [in] progmem  **true** (default) if levels is in PROGMEM, **false** if it's in RAM
+     */
+    FadeLedScene(FadeLed* const* leds, const flvar_t* levels, unsigned int count, bool progmem = true);
+
+    /**
+     *  @brief Destructor, drops the fade()'s tick() didn't handle yet
+     */
+    ~FadeLedScene();
+
+    /**
+     *  @brief Crossfade all objects of the scene to it
+     *
+     *  @details All fades start at the same tick and take the same time. With #FADE_LED_ISR or #FADE_LED_MULTICORE it's one command in the queue for the whole scene.
+     *
+     *  @param [in] time The time (ms) the crossfade takes
+     */
+    void fade(unsigned long time);
+
+    /**
+     *  @brief Returns if all objects of the scene are done fading
+     */
+    bool done();
+
+    /**
+     *  @brief Returns the brightness of the scene for an object
+     *
+     *  @param [in] index The object, 0 is the first of the list
+     */
+    flvar_t getLevel(unsigned int index);
+
+    /**
+     *  @brief Returns the number of brightnesses in the scene
+     */
+    unsigned int getCount();
+
+  protected:
+    /**
+     *  @brief Implementation of fade(), changes the objects directly
+     */
+    void fadeNow(unsigned long time);
+
+    /**
+     *  @brief Stores the brightness each object is set to, for #_count objects
+     *
+     *  @param [out] levels Array of #_count brightnesses
+     */
+    void captureLevels(flvar_t* levels);
+
+    FadeLed* const* const _leds; //!< The objects of the scene
+    const flvar_t* _levels; //!< Brightness for each object
+    unsigned int _count; //!< Number of brightnesses
+    bool _progmem; //!< #_levels is in PROGMEM
+    #if FADE_LED_QUEUE
+    byte _queued; //!< Number of fade()'s put in the queue (rolls over)
+    byte _applied; //!< Number of those handled by tick() (rolls over)
+    #endif
+
+    friend class FadeLed;
+};
+
+/**
+ *  @brief A scene in RAM that can store the brightnesses of now
+ *
+ *  @details capture() stores the brightness each object is set to, so fade() can go back to it later. Or fill it with setLevel().
+ *
+ *  ```C++
+ *  FadeLedSnapshot<3> before(Leds);
+ *
+ *  void startShow(){
+ *    before.capture();
+ *    show.fade(1000);
+ *  }
+ *
+ *  void endShow(){
+ *    before.fade(1000);
+ *  }
+ *  ```
+ *
+ *  With #FADE_LED_ISR or #FADE_LED_MULTICORE only change it when it's done(), a fade() in the queue reads it when tick() handles it.
+ *
+ *  @tparam Leds Number of objects in the scene
+ */
+template <unsigned int Leds>
+class FadeLedSnapshot : public FadeLedScene{
+  public:
+    /**
+     *  @brief Constructor, all brightnesses 0
+     *
+     *  @param [in] leds The objects of the scene, Leds of them
+     */
+    FadeLedSnapshot(FadeLed* const* leds) : FadeLedScene(leds, _snapshot, Leds, false), _snapshot(){
+
+    }
+
+    /**
+     *  @brief Stores the brightness each object is set to
+     *
+     *  @details The brightness it fades to (FadeLed::get()), not the brightness of halfway a fade. A nullptr in the list is stored as 0.
+     */
+    void capture(){
+      captureLevels(_snapshot);
+    }
+
+    /**
+     *  @brief Set the brightness of the scene for an object
+     *
+     *  @param [in] index The object, 0 is the first of the list
+     *  @param [in] level The brightness
+     */
+    void setLevel(unsigned int index, flvar_t level){
+      if(index < Leds){
+        _snapshot[index] = level;
+      }
+    }
+
+  protected:
+    flvar_t _snapshot[Leds]; //!< The brightnesses
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+#include "FadeLedSequence.h"
+
+FadeLedSequence* FadeLedSequence::_sequenceList = nullptr;
+
+FadeLedSequence::FadeLedSequence(FadeLed& led) :
+  _led(led),
+  _keyframes(nullptr),
+  _index(0),
+  _repeats(0),
+  _repeating(false),
+  _started(false),
+  #if FADE_LED_TICKS
+  _holdEnd(0),
+  #else
+  _holdTicks(0),
+  #endif
+  _nextSequence(_sequenceList)
+{
+  _sequenceList = this;
+  FadeLed::_hooks[FadeLed::HookSequence] = updateAll;
+}
+
+FadeLedSequence::~FadeLedSequence(){
+  FadeLedSequence** link = &_sequenceList;
+  while(*link && *link != this){
+    link = &(*link)->_nextSequence;
+  }
+  if(*link){
+    *link = _nextSequence;
+  }
+}
+
+void FadeLedSequence::play(const FadeLedKeyframe* keyframes){
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may not see it halfway
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    _index = 0;
+    _repeating = false;
+    _started = false;
+    _keyframes = keyframes;
+  }
+}
+
+void FadeLedSequence::stop(){
+  #if FADE_LED_ISR && defined(__AVR__)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    _keyframes = nullptr;
+  }
+}
+
+bool FadeLedSequence::playing(){
+  return _keyframes != nullptr;
+}
+
+void FadeLedSequence::updateAll(){
+  for(FadeLedSequence* sequence = _sequenceList; sequence; sequence = sequence->_nextSequence){
+    if(sequence->_keyframes){
+      sequence->updateThis();
+    }
+  }
+}
+
+void FadeLedSequence::updateThis(){
+  const FadeLedKeyframe* keyframe = _keyframes + _index;
+
+  //check if the keyframe playing is finished
+  if(_started){
+    byte type = pgm_read_byte_near(&keyframe->type);
+    if(type == FadeLedKeyframe::Hold){
+      #if FADE_LED_TICKS
+      if((long)(FadeLed::_tick - _holdEnd) < 0){
+        return;
+      }
+      #else
+      if(--_holdTicks){
+        return;
+      }
+      #endif
+    }
+    else if(!_led.doneNow()){
+      return;
+    }
+    _index++;
+  }
+
+  //start keyframes until one takes time
+  for(byte i = 0; i < MaxInstant && _keyframes; i++){
+    if(startKeyframe()){
+      _started = true;
+      return;
+    }
+  }
+  _started = false;
+}
+
+bool FadeLedSequence::startKeyframe(){
+  const FadeLedKeyframe* keyframe = _keyframes + _index;
+  byte type = pgm_read_byte_near(&keyframe->type);
+  flvar_t value = FadeLedGammaReadLevel(&keyframe->value);
+  uint16_t time = pgm_read_word_near(&keyframe->time);
+
+  switch(type){
+    case FadeLedKeyframe::Fade:
+    case FadeLedKeyframe::FadeSpeed:
+      //directly, also with FADE_LED_ISR this runs in tick()
+      _led.setTimeNow(time, type == FadeLedKeyframe::Fade);
+      _led.setNow(value);
+      if(!_led.doneNow()){
+        return true;
+      }
+      break;
+    case FadeLedKeyframe::JumpTo:
+      _led.beginNow(value);
+      break;
+    case FadeLedKeyframe::Hold:
+      //shorter than an interval is no hold
+      if(time < FadeLed::_interval){
+        break;
+      }
+      #if FADE_LED_TICKS
+      _holdEnd = FadeLed::_tick + time / FadeLed::_interval;
+      #else
+      _holdTicks = time / FadeLed::_interval;
+      #endif
+      return true;
+    case FadeLedKeyframe::GoTo:
+      _index = value;
+      return false;
+    case FadeLedKeyframe::Repeat:
+      if(!_repeating){
+        _repeating = true;
+        _repeats = time;
+      }
+      if(_repeats){
+        _repeats--;
+        _index = value;
+        return false;
+      }
+      _repeating = false;
+      break;
+    default:
+      _keyframes = nullptr;
+      return false;
+  }
+
+  _index++;
+  return false;
+}
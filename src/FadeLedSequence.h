@@ -0,0 +1,205 @@
+/**
+ *  @file FadeLedSequence.h
+ *  @brief Playing a sequence of fades from PROGMEM.
+ *
+ *  @details A sequence is a list of keyframes (fade to a brightness, hold, jump back...) in PROGMEM. A FadeLedSequence plays it on a FadeLed object from within FadeLed::update(), so a pattern runs without any code in loop(). The keyframes are read from PROGMEM one at a time, nothing is copied to RAM.
+ */
+
+#ifndef _FADE_LED_SEQUENCE_H
+#define _FADE_LED_SEQUENCE_H
+
+#include "FadeLed.h"
+
+/**
+ *  @brief One step of a sequence
+ *
+ *  @details Make them with FadeLedFade(), FadeLedFadeSpeed(), FadeLedJumpTo(), FadeLedHold(), FadeLedGoTo(), FadeLedRepeat() and FadeLedEnd(). 4 bytes (5 for more than 8-bit PWM).
+ */
+struct FadeLedKeyframe{
+  flvar_t value; //!< Brightness to fade to, or the keyframe to go to
+  uint16_t time; //!< Time (ms) of the fade or hold, or the number of repeats
+  byte type; //!< What to do, one of #FadeLedKeyframe::Type
+
+  /**
+   *  @brief What a keyframe does
+   */
+  enum Type{
+    Fade, //!< Fade to value in time ms (constant fade time)
+    FadeSpeed, //!< Fade to value with the speed of a full fade in time ms (constant fade speed)
+    JumpTo, //!< Go to value directly (FadeLed::begin())
+    Hold, //!< Keep the brightness for time ms
+    GoTo, //!< Continue at keyframe value
+    Repeat, //!< Continue at keyframe value, time times, then go on
+    End //!< Stop the sequence
+  };
+};
+
+/**
+ *  @brief Keyframe that fades to a brightness in a fixed time
+ *
+ *  @param [in] value Brightness to fade to
+ *  @param [in] time  Time (ms) the fade takes, max 65535
+ */
+constexpr FadeLedKeyframe FadeLedFade(flvar_t value, uint16_t time){
+  return {value, time, FadeLedKeyframe::Fade};
+}
+
+/**
+ *  @brief Keyframe that fades to a brightness with a fixed speed
+ *
+ *  @param [in] value Brightness to fade to
+ *  @param [in] time  Time (ms) a fade over the full range takes, max 65535
+ */
+constexpr FadeLedKeyframe FadeLedFadeSpeed(flvar_t value, uint16_t time){
+  return {value, time, FadeLedKeyframe::FadeSpeed};
+}
+
+/**
+ *  @brief Keyframe that goes to a brightness directly, without fading
+ *
+ *  @param [in] value The new brightness
+ */
+constexpr FadeLedKeyframe FadeLedJumpTo(flvar_t value){
+  return {value, 0, FadeLedKeyframe::JumpTo};
+}
+
+/**
+ *  @brief Keyframe that keeps the brightness for some time
+ *
+ *  @param [in] time Time (ms) to wait, max 65535
+ */
+constexpr FadeLedKeyframe FadeLedHold(uint16_t time){
+  return {0, time, FadeLedKeyframe::Hold};
+}
+
+/**
+ *  @brief Keyframe that continues the sequence at another keyframe
+ *
+ *  @details Going back makes a loop that runs forever. A loop needs at least one fade or hold.
+ *
+ *  @param [in] index Keyframe to continue at, 0 is the first
+ */
+constexpr FadeLedKeyframe FadeLedGoTo(flvar_t index){
+  return {index, 0, FadeLedKeyframe::GoTo};
+}
+
+/**
+ *  @brief Keyframe that repeats a part of the sequence
+ *
+ *  @details Continues at keyframe index for count times, after that the sequence goes on after this keyframe. A sequence can only have one repeat running at a time, so no nested repeats.
+ *
+ *  @param [in] index Keyframe to continue at, 0 is the first
+ *  @param [in] count Number of times to go back
+ */
+constexpr FadeLedKeyframe FadeLedRepeat(flvar_t index, uint16_t count){
+  return {index, count, FadeLedKeyframe::Repeat};
+}
+
+/**
+ *  @brief Keyframe that stops the sequence
+ */
+constexpr FadeLedKeyframe FadeLedEnd(){
+  return {0, 0, FadeLedKeyframe::End};
+}
+
+/**
+ *  @brief Plays a sequence of keyframes on a FadeLed object
+ *
+ *  @details Each update the player checks if the current keyframe is finished (the fade is done or the hold time passed) and then starts the next one. All from within FadeLed::update() (or FadeLed::tick() with #FADE_LED_ISR), loop() doesn't need to do anything.
+ *
+ *  ```C++
+ *  const FadeLedKeyframe Breathe[] PROGMEM = {
+ *    FadeLedFade(100, 1500),
+ *    FadeLedFade(10, 2500),
+ *    FadeLedHold(500),
+ *    FadeLedGoTo(0)
+ *  };
+ *
+ *  FadeLed led(5);
+ *  FadeLedSequence breathe(led);
+ *
+ *  void setup(){
+ *    breathe.play(Breathe);
+ *  }
+ *
+ *  void loop(){
+ *    FadeLed::update();
+ *  }
+ *  ```
+ *
+ *  A fade of a keyframe changes the fade time (and mode) of the FadeLed object. Changing the object yourself while the sequence plays gives funny results, stop() the sequence first.
+ */
+class FadeLedSequence{
+  public:
+    /**
+     *  @brief Constructor, links the player in the list FadeLed::update() uses
+     *
+     *  @param [in] led The FadeLed object to play on
+     */
+    FadeLedSequence(FadeLed& led);
+
+    /**
+     *  @brief Destructor, removes the player from the list FadeLed::update() uses
+     */
+    ~FadeLedSequence();
+
+    /**
+     *  @brief Starts playing a sequence from the first keyframe
+     *
+     *  @details The first keyframe starts on the next update. With #FADE_LED_ISR on another platform than AVR, only call it when the timer interrupt can't run.
+     *
+     *  @param [in] keyframes The keyframes in PROGMEM, the sequence must end with FadeLedEnd() or loop with FadeLedGoTo()
+     */
+    void play(const FadeLedKeyframe* keyframes);
+
+    /**
+     *  @brief Stops playing
+     *
+     *  @details The FadeLed object finishes the fade it's in.
+     */
+    void stop();
+
+    /**
+     *  @brief Returns if a sequence is playing
+     */
+    bool playing();
+
+    /**
+     *  @brief Advances all players
+     *
+     *  @details Called by FadeLed::update() each interval once the first player is made, you don't need to call it yourself.
+     */
+    static void updateAll();
+
+  protected:
+    /**
+     *  @brief Checks if the current keyframe is finished and starts the next ones
+     */
+    void updateThis();
+
+    /**
+     *  @brief Starts the keyframe at #_index
+     *
+     *  @return true if it takes time (a fade or hold), false if it's done right away
+     */
+    bool startKeyframe();
+
+    FadeLed& _led; //!< The object to play on
+    const FadeLedKeyframe* _keyframes; //!< The sequence in PROGMEM, nullptr if not playing
+    unsigned int _index; //!< Keyframe playing now
+    uint16_t _repeats; //!< Repeats left of the FadeLedRepeat() running
+    bool _repeating; //!< A FadeLedRepeat() is running
+    bool _started; //!< The keyframe at #_index is started
+    #if FADE_LED_TICKS
+    unsigned long _holdEnd; //!< Tick a hold ends
+    #else
+    unsigned long _holdTicks; //!< Ticks left of a hold
+    #endif
+    FadeLedSequence* _nextSequence; //!< Next player in the list of players
+
+    static FadeLedSequence* _sequenceList; //!< First player
+
+    static const byte MaxInstant = 16; //!< Keyframes that take no time handled per update, stops a loop without fade or hold
+};
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ *  @file FadeLedStep.h
+ *  @brief Division free stepping of a fade, shared by FadeLed, FadeLedCore, FadeLedGroup and FadeLedLayers.
+ *
+ *  @details A fade of dist steps over countMax intervals is count * dist / countMax steps on its way after count intervals. FadeLedStep keeps that as whole steps and a remainder in 1/countMax steps, so each interval it only adds and compares. Only when a fade starts or jumps (a late update with #FADE_LED_ELAPSED_TIME) it divides, with FadeLedStepPos().
+ */
+
+#ifndef _FADE_LED_STEP_H
+#define _FADE_LED_STEP_H
+
+/**
+ *  @brief Steps on the way after count intervals, count * dist / countMax
+ *
+ *  @details Without 64-bit math, also if count * dist doesn't fit 32 bits. From countMax intervals on it's dist, so also for a countMax of 0.
+ *
+ *  @param [in]  count    Intervals passed
+ *  @param [in]  dist     Steps of the whole fade
+ *  @param [in]  countMax Intervals the whole fade takes
+ *  @param [out] rem      Remainder, in 1/countMax steps
+ *  @return Whole steps on the way
+ */
+inline unsigned int FadeLedStepPos(flcount_t count, unsigned int dist, flcount_t countMax, flcount_t& rem){
+  if(count >= countMax){
+    rem = 0;
+    return dist;
+  }
+
+  //dist is 16 bits at most, so with 16 bits of count it fits (always with 1 or 2 byte counters)
+  if(count <= 0xFFFF){
+    unsigned long total = (unsigned long)count * dist;
+    rem = total % countMax;
+    return total / countMax;
+  }
+
+  //long division a bit of dist at a time, the remainder stays below countMax so it can't overflow
+  unsigned int pos = 0;
+  flcount_t r = 0;
+  for(unsigned int bit = 0x8000; bit; bit >>= 1){
+    pos <<= 1;
+    if(r >= countMax - r){
+      r -= countMax - r;
+      pos++;
+    }
+    else{
+      r <<= 1;
+    }
+    if(dist & bit){
+      if(r >= countMax - count){
+        r -= countMax - count;
+        pos++;
+      }
+      else{
+        r += count;
+      }
+    }
+  }
+  rem = r;
+  return pos;
+}
+
+/**
+ *  @brief Brightness of a fade from startVal to setVal after pos steps
+ *
+ *  @details Never past setVal, also if startVal + pos doesn't fit #flvar_t.
+ */
+inline flvar_t FadeLedStepTo(flvar_t startVal, flvar_t setVal, unsigned int pos){
+  if(setVal > startVal){
+    return (pos < (unsigned int)(setVal - startVal)) ? startVal + pos : setVal;
+  }
+  return (pos < (unsigned int)(startVal - setVal)) ? startVal - pos : setVal;
+}
+
+/**
+ *  @brief The steps of a fade, moved one interval at a time
+ *
+ *  @tparam Pos Type of the steps, big enough for dist
+ */
+template <typename Pos>
+struct FadeLedStep{
+  Pos pos; //!< Steps on the way at the current count
+  Pos div; //!< Whole steps to add each interval
+  flcount_t err; //!< Remainder of #pos, in 1/countMax steps
+  flcount_t mod; //!< Remainder to add each interval, in 1/countMax steps
+
+  /**
+   *  @brief Sets up the steps of a fade after count intervals
+   *
+   *  @details Needs to be called when a fade starts, jumps or when countMax or dist changes.
+   *
+   *  @param [in] count    Intervals passed
+   *  @param [in] dist     Steps of the whole fade
+   *  @param [in] countMax Intervals the whole fade takes, 0 to go directly
+   */
+  void setup(flcount_t count, Pos dist, flcount_t countMax){
+    //no time to fade, go directly
+    if(countMax == 0){
+      pos = dist;
+      div = dist;
+      err = 0;
+      mod = 0;
+      return;
+    }
+    pos = FadeLedStepPos(count, dist, countMax, err);
+    div = dist / countMax;
+    mod = dist % countMax;
+  }
+
+  /**
+   *  @brief Moves the steps one interval
+   *
+   *  @details Only adds and compares.
+   *
+   *  @param [in] countMax Intervals the whole fade takes, as given to setup()
+   */
+  void next(flcount_t countMax){
+    pos += div;
+    //compared before adding, the sum may not fit flcount_t
+    if(err >= countMax - mod){
+      err -= countMax - mod;
+      pos++;
+    }
+    else{
+      err += mod;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "Arduino.h"
+#include "FadeLed.h"
+
+#if FADE_LED_TRACE
+FadeLedTraceRecord FadeLedTrace::_records[FADE_LED_TRACE_SIZE];
+uint32_t FadeLedTrace::_total = 0;
+volatile bool FadeLedTrace::_recording = true;
+
+void FadeLedTrace::start(){
+  _recording = true;
+}
+
+void FadeLedTrace::stop(){
+  #if FADE_LED_ISR && defined(__AVR__)
+  //tick() may be halfway a record
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  #endif
+  {
+    _recording = false;
+  }
+}
+
+bool FadeLedTrace::recording(){
+  return _recording;
+}
+
+void FadeLedTrace::clear(){
+  bool wasRecording = _recording;
+  stop();
+  _total = 0;
+  if(wasRecording){
+    start();
+  }
+}
+
+unsigned int FadeLedTrace::count(){
+  return (_total < FADE_LED_TRACE_SIZE) ? _total : FADE_LED_TRACE_SIZE;
+}
+
+uint32_t FadeLedTrace::total(){
+  return _total;
+}
+
+FadeLedTraceHeader FadeLedTrace::makeHeader(){
+  FadeLedTraceHeader header = {{'F', 'L', 'T', 'R'}, 1, FADE_LED_PWM_BITS, 0, 0, FADE_LED_TRACE_SIZE, _total};
+  header.interval = FadeLed::getInterval();
+  header.count = count();
+  return header;
+}
+
+FadeLedTraceRecord FadeLedTrace::read(unsigned int index){
+  uint32_t first = _total - count();
+  return _records[(first + index) & (FADE_LED_TRACE_SIZE - 1)];
+}
+#endif
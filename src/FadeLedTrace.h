@@ -0,0 +1,157 @@
+/**
+ *  @file FadeLedTrace.h
+ *  @brief Recording what FadeLed writes to the outputs, to find flicker.
+ *
+ *  @details With #FADE_LED_TRACE every output write, every tick and every fade that starts is put in a ring buffer with the time (micros()) it happened. dump() sends the buffer in a compact binary format, `extras/TraceAnalyze.py` reads it and reports the jitter of the ticks, the step sizes, steps against the fade direction and how long the fades took compared to setTime().
+ */
+
+#ifndef _FADE_LED_TRACE_H
+#define _FADE_LED_TRACE_H
+
+/**
+ *  @brief One record of the trace, 8 bytes
+ */
+struct FadeLedTraceRecord{
+  uint32_t time; //!< micros() of the record, for a #Duration record the expected duration (ms) of the fade before
+  uint16_t value; //!< Output level written, or for a #Fade record the output level the fade ends at
+  byte pin; //!< Pin (or channel of an output backend), 0 for a #Tick record
+  byte type; //!< What happened, one of #FadeLedTraceRecord::Type
+
+  /**
+   *  @brief What a record is
+   */
+  enum Type{
+    Write, //!< An output level was written
+    Tick, //!< FadeLed::tick() started
+    Fade, //!< A fade started (FadeLed::set()), always followed by a #Duration record
+    Duration //!< The expected duration of the fade before, 0 if not known (a fade with an easing curve in constant fade speed, or a constant speed fade that got a further brightness)
+  };
+};
+
+/**
+ *  @brief Header of dump(), 16 bytes, the records (oldest first) follow it
+ */
+struct FadeLedTraceHeader{
+  char magic[4]; //!< "FLTR"
+  byte version; //!< Version of the format, 1
+  byte pwmBits; //!< #FADE_LED_PWM_BITS
+  uint16_t interval; //!< FadeLed::getInterval() in ms
+  uint16_t count; //!< Number of records that follow
+  uint16_t size; //!< #FADE_LED_TRACE_SIZE
+  uint32_t total; //!< Number of records ever made, more than count if the oldest are overwritten
+};
+
+/**
+ *  @brief Ring buffer of the last #FADE_LED_TRACE_SIZE writes, ticks and fades
+ *
+ *  @details Records from the start, all functions are static. To get a trace to the PC:
+ *
+ *  ```C++
+ *  //after the flicker was seen
+ *  FadeLedTrace::dump(Serial);
+ *  ```
+ *
+ *  Save what's received to a file (like with `extras/TraceAnalyze.py --serial`) and run `python extras/TraceAnalyze.py trace.bin`. All numbers are written in the byte order of the board (little endian on AVR, ARM and ESP).
+ */
+class FadeLedTrace{
+  //the ring index is masked and the header has 16 bit fields
+  static_assert(FADE_LED_TRACE_SIZE > 0 && (FADE_LED_TRACE_SIZE & (FADE_LED_TRACE_SIZE - 1)) == 0 && FADE_LED_TRACE_SIZE <= 65535,
+                "FADE_LED_TRACE_SIZE must be a power of 2 up to 32768");
+
+  public:
+    /**
+     *  @brief Starts (or continues) recording
+     */
+    static void start();
+
+    /**
+     *  @brief Stops recording, the records stay
+     */
+    static void stop();
+
+    /**
+     *  @brief Returns if it's recording
+     */
+    static bool recording();
+
+    /**
+     *  @brief Removes all records
+     */
+    static void clear();
+
+    /**
+     *  @brief Returns the number of records in the buffer
+     */
+    static unsigned int count();
+
+    /**
+     *  @brief Returns the number of records ever made (rolls over)
+     */
+    static uint32_t total();
+
+    /**
+     *  @brief Returns a record
+     *
+     *  @param [in] index 0 is the oldest, count() - 1 the newest
+     */
+    static FadeLedTraceRecord read(unsigned int index);
+
+    /**
+     *  @brief Sends the header and all records
+     *
+     *  @details Stops recording while sending. Anything with a `write(const uint8_t* buffer, size_t size)` can be used, like Serial or a File.
+     *
+     *  @param [in] out Where to write to
+     */
+    template<class Out>
+    static void dump(Out& out);
+
+    /**
+     *  @brief Adds a record, overwrites the oldest if full
+     *
+     *  @details Called by FadeLed, you don't need to call it yourself.
+     */
+    static void record(byte type, byte pin, uint16_t value, uint32_t time);
+
+  protected:
+    /**
+     *  @brief Returns the header of dump() for the records now
+     */
+    static FadeLedTraceHeader makeHeader();
+
+    static FadeLedTraceRecord _records[FADE_LED_TRACE_SIZE]; //!< The ring buffer
+    static uint32_t _total; //!< Records made, the next goes to _total % #FADE_LED_TRACE_SIZE
+    static volatile bool _recording; //!< Records are made
+};
+
+inline void FadeLedTrace::record(byte type, byte pin, uint16_t value, uint32_t time){
+  if(!_recording){
+    return;
+  }
+  FadeLedTraceRecord& rec = _records[_total & (FADE_LED_TRACE_SIZE - 1)];
+  rec.time = time;
+  rec.value = value;
+  rec.pin = pin;
+  rec.type = type;
+  _total++;
+}
+
+template<class Out>
+void FadeLedTrace::dump(Out& out){
+  bool wasRecording = _recording;
+  stop();
+
+  FadeLedTraceHeader header = makeHeader();
+  out.write((const uint8_t*)&header, sizeof(header));
+
+  for(unsigned int i = 0; i < header.count; i++){
+    FadeLedTraceRecord rec = read(i);
+    out.write((const uint8_t*)&rec, sizeof(rec));
+  }
+
+  if(wasRecording){
+    start();
+  }
+}
+
+#endif